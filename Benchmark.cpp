@@ -0,0 +1,1047 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LitDecode.h"
+#include "LitDocument.h"
+#include "LitJson.h"
+#include "LitLazy.h"
+#include "LitMemory.h"
+#include "LitNdjson.h"
+#include "LitPointer.h"
+#include "LitPushParser.h"
+#include "LitReader.h"
+#include "LitShapeCache.h"
+#include "LitSink.h"
+#include "LitTape.h"
+
+// per thread, so the counters stay race-free when a benchmark runs worker threads. alloc_live may wrap when memory
+// moves to another thread, only single-threaded benchmarks read it.
+static thread_local size_t alloc_count = 0;
+static thread_local size_t alloc_bytes = 0;
+static thread_local size_t alloc_live = 0;
+static thread_local size_t alloc_peak = 0;
+
+// every block starts with its size so operator delete can take it off alloc_live, the header keeps the
+// alignment malloc gives
+static const size_t kAllocHeader = 16;
+
+void* operator new(size_t n) {
+    ++alloc_count;
+    alloc_bytes += n;
+    alloc_live += n;
+    alloc_peak = std::max(alloc_peak, alloc_live);
+    char* p = static_cast<char*>(malloc(n + kAllocHeader));
+    if (p == nullptr) throw std::bad_alloc();
+    memcpy(p, &n, sizeof(n));
+    return p + kAllocHeader;
+}
+void operator delete(void* p) noexcept {
+    if (p == nullptr) return;
+    char* block = static_cast<char*>(p) - kAllocHeader;
+    size_t n;
+    memcpy(&n, block, sizeof(n));
+    alloc_live -= n;
+    free(block);
+}
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+// {"id":0,"name":"node-0","tags":["a","b"],"children":[{...},{...}]} nested `depth` levels
+static void GenNested(std::string* json, int depth, int* id) {
+    char buff[32];
+    sprintf(buff, "%d", (*id)++);
+    *json += "{\"id\":";
+    *json += buff;
+    *json += ",\"name\":\"node-";
+    *json += buff;
+    *json += "\",\"tags\":[\"alpha\",\"beta\",\"gamma\"],\"children\":[";
+    if (depth > 0) {
+        for (int i = 0; i < 4; ++i) {
+            if (i > 0) json->push_back(',');
+            GenNested(json, depth - 1, id);
+        }
+    }
+    *json += "]}";
+}
+
+// telemetry-like records: short decimals, full precision doubles, counters and exponents
+static void GenNumbers(std::string* json, int count) {
+    char buff[64];
+    unsigned seed = 12345;
+    json->push_back('[');
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 1103515245 + 12345;
+        if (i > 0) json->push_back(',');
+        switch (i % 4) {
+            case 0: sprintf(buff, "%.2f", (seed % 100000) / 100.0); break;
+            case 1: sprintf(buff, "%.17g", seed / 4294967296.0 * 360.0 - 180.0); break;
+            case 2: sprintf(buff, "%u", seed % 1000000); break;
+            case 3: sprintf(buff, "%.6e", (seed % 1000) * 1.5e-9); break;
+        }
+        *json += buff;
+    }
+    json->push_back(']');
+}
+
+// integer-heavy records: 64-bit ids above 2^53, millisecond timestamps, small counters and signed deltas
+static void GenIntegers(std::string* json, int count) {
+    char buff[64];
+    unsigned long long seed = 12345;
+    json->push_back('[');
+    for (int i = 0; i < count; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        if (i > 0) json->push_back(',');
+        switch (i % 4) {
+            case 0: sprintf(buff, "%llu", seed | (1ULL << 62)); break;
+            case 1: sprintf(buff, "%llu", 1600000000000ULL + (seed >> 30) % 100000000000ULL); break;
+            case 2: sprintf(buff, "%llu", (seed >> 40) % 1000); break;
+            case 3: sprintf(buff, "%lld", static_cast<long long>((seed >> 20) % 2000000) - 1000000); break;
+        }
+        *json += buff;
+    }
+    json->push_back(']');
+}
+
+// re-indent compact json with two spaces per level
+static std::string Pretty(const std::string& json) {
+    std::string res;
+    int depth = 0;
+    bool in_string = false;
+    for (size_t i = 0; i < json.size(); ++i) {
+        char ch = json[i];
+        if (in_string) {
+            res.push_back(ch);
+            if (ch == '\\') {
+                res.push_back(json[++i]);
+            } else if (ch == '\"') {
+                in_string = false;
+            }
+            continue;
+        }
+        switch (ch) {
+            case '\"':
+                res.push_back(ch);
+                in_string = true;
+                break;
+            case '{':
+            case '[':
+                res.push_back(ch);
+                if (json[i + 1] == '}' || json[i + 1] == ']') {
+                    res.push_back(json[++i]);
+                } else {
+                    res += "\n" + std::string(2 * ++depth, ' ');
+                }
+                break;
+            case '}':
+            case ']':
+                res += "\n" + std::string(2 * --depth, ' ');
+                res.push_back(ch);
+                break;
+            case ',': res += ",\n" + std::string(2 * depth, ' '); break;
+            case ':': res += ": "; break;
+            default: res.push_back(ch);
+        }
+    }
+    return res;
+}
+
+// array of long log-message and base64 strings, the odd escape every few hundred bytes
+static void GenLongStrings(std::string* json, int count, int len) {
+    static const char* kBase64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    json->push_back('[');
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) json->push_back(',');
+        json->push_back('\"');
+        for (int j = 0; j < len; ++j) {
+            if (i % 2 == 0) {
+                json->push_back(kBase64[(i * 31 + j * 7) % 64]);
+            } else if (j % 300 == 299) {
+                *json += "\\n";
+            } else {
+                json->push_back("request served in 12 ms by worker "[j % 34]);
+            }
+        }
+        json->push_back('\"');
+    }
+    json->push_back(']');
+}
+
+// flat config object: {"feature.flag.0":0,"feature.flag.1":1,...}
+static void GenConfig(std::string* json, int count) {
+    json->push_back('{');
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) json->push_back(',');
+        *json += "\"feature.flag." + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    json->push_back('}');
+}
+
+// `count` lines of {"id":N,"user":"user-N","score":N.5,"tags":["x","y"],"active":true}
+static void GenNdjson(std::string* json, int count) {
+    for (int i = 0; i < count; ++i) {
+        *json += "{\"id\":" + std::to_string(i) + ",\"user\":\"user-" + std::to_string(i % 1000) +
+                 "\",\"score\":" + std::to_string(i % 977) + ".5,\"tags\":[\"x\",\"y\"],\"active\":" +
+                 (i % 3 ? "true" : "false") + "}\n";
+    }
+}
+
+// a ~50 KB API payload: metadata, a few hundred nested records, the fields a handler usually wants at the end
+static void GenPayload(std::string* json) {
+    *json += "{\"meta\":{\"version\":3,\"region\":\"eu-west\",\"flags\":[\"a\",\"b\",\"c\"]},\"items\":[";
+    for (int i = 0; i < 250; ++i) {
+        if (i > 0) *json += ",";
+        *json += "{\"id\":" + std::to_string(i) + ",\"sku\":\"SKU-" + std::to_string(i * 7919) +
+                 "\",\"price\":" + std::to_string(i % 100) + ".99,\"tags\":[\"x\",\"y\",\"z\"],\"dims\":{\"w\":" +
+                 std::to_string(i % 13) + ",\"h\":" + std::to_string(i % 17) + ",\"d\":0.5},\"note\":\"item \\\"" +
+                 std::to_string(i) + "\\\" ok\"}";
+    }
+    *json += "],\"request_id\":\"req-0001\",\"user\":{\"id\":12345,\"name\":\"someone\"},\"total\":1234.5}";
+}
+
+// the same records as one array: [{"id":0,...},{"id":1,...},...]
+static void GenRecords(std::string* json, int count) {
+    GenNdjson(json, count);
+    std::replace(json->begin(), json->end(), '\n', ',');
+    json->back() = ']';
+    json->insert(json->begin(), '[');
+}
+
+// xorshift64*, the corpus is the same on every run and every platform
+static uint64_t NextRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+// canada.json-like: one polygon of ~58k coordinate pairs printed with 17 significant digits, ~2 MB of doubles
+static void GenCanada(std::string* json) {
+    uint64_t seed = 1;
+    char buff[64];
+    *json += "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},"
+             "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+    for (int ring = 0; ring < 480; ++ring) {
+        if (ring > 0) json->push_back(',');
+        json->push_back('[');
+        double x = -141.0 + NextRandom(&seed) % 8000 / 100.0, y = 42.0 + NextRandom(&seed) % 4000 / 100.0;
+        for (int i = 0; i < 120; ++i) {
+            x += (static_cast<double>(NextRandom(&seed) % 20001) - 10000.0) / 1e7;
+            y += (static_cast<double>(NextRandom(&seed) % 20001) - 10000.0) / 1e7;
+            sprintf(buff, "%s[%.17g,%.17g]", i > 0 ? "," : "", x, y);
+            *json += buff;
+        }
+        json->push_back(']');
+    }
+    *json += "]}}]}";
+}
+
+// twitter.json-like: statuses with a nested user and entities. Short strings with escapes and UTF-8, ids both as
+// numbers and strings, plenty of null and false
+static void GenTwitter(std::string* json) {
+    static const char* kTexts[] = {
+        "RT @someone: \\u3010\\u5b9a\\u671f\\u3011 \\u304a\\u306f\\u3088\\u3046\\u3054\\u3056\\u3044\\u307e\\u3059",
+        "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE\xE3\x83\x84\xE3\x82\xA4\xE3\x83\xBC\xE3\x83\x88 #tag",
+        "just setting up my account, see http:\\/\\/t.co\\/abcdEFGH \\\"quoted\\\"",
+        "caf\\u00e9 \\ud83d\\ude00 line one\\nline two"};
+    uint64_t seed = 2;
+    *json += "{\"statuses\":[";
+    for (int i = 0; i < 400; ++i) {
+        uint64_t id = 505874924095815681ULL - NextRandom(&seed) % 1000000;
+        uint64_t user = NextRandom(&seed) % 3000000000ULL;
+        std::string ids = std::to_string(id), users = std::to_string(user);
+        if (i > 0) json->push_back(',');
+        *json += "{\"metadata\":{\"result_type\":\"recent\",\"iso_language_code\":\"ja\"},\"created_at\":\"Sun Aug 31 "
+                 "00:29:15 +0000 2014\",\"id\":" + ids + ",\"id_str\":\"" + ids + "\",\"text\":\"" +
+                 kTexts[i % 4] + "\",\"source\":\"<a href=\\\"http:\\/\\/twitter.com\\/download\\/iphone\\\" rel=\\\""
+                 "nofollow\\\">Twitter for iPhone<\\/a>\",\"truncated\":false,\"in_reply_to_status_id\":null,"
+                 "\"in_reply_to_user_id\":null,\"in_reply_to_screen_name\":null,\"user\":{\"id\":" + users +
+                 ",\"id_str\":\"" + users + "\",\"name\":\"user " + std::to_string(i) + "\",\"screen_name\":\"u" +
+                 std::to_string(i) + "\",\"location\":\"\",\"description\":\"" + kTexts[(i + 1) % 4] +
+                 "\",\"url\":null,\"entities\":{\"description\":{\"urls\":[]}},\"protected\":false,"
+                 "\"followers_count\":" + std::to_string(NextRandom(&seed) % 100000) + ",\"friends_count\":" +
+                 std::to_string(NextRandom(&seed) % 5000) + ",\"listed_count\":0,\"created_at\":\"Wed Jul 30 "
+                 "04:25:33 +0000 2014\",\"favourites_count\":7,\"utc_offset\":null,\"time_zone\":null,"
+                 "\"geo_enabled\":false,\"verified\":false,\"statuses_count\":" +
+                 std::to_string(NextRandom(&seed) % 20000) + ",\"lang\":\"ja\",\"profile_background_color\":"
+                 "\"C0DEED\",\"profile_image_url\":\"http:\\/\\/pbs.twimg.com\\/profile_images\\/" + users +
+                 "\\/normal.png\",\"default_profile\":true,\"following\":false,\"notifications\":false},"
+                 "\"geo\":null,\"coordinates\":null,\"place\":null,\"contributors\":null,\"retweet_count\":" +
+                 std::to_string(NextRandom(&seed) % 100) + ",\"favorite_count\":0,\"entities\":{\"hashtags\":[{"
+                 "\"text\":\"tag\",\"indices\":[40,44]}],\"symbols\":[],\"urls\":[],\"user_mentions\":[{"
+                 "\"screen_name\":\"someone\",\"name\":\"some one\",\"id\":1186275104,\"id_str\":\"1186275104\","
+                 "\"indices\":[3,11]}]},\"favorited\":false,\"retweeted\":false,\"lang\":\"ja\"}";
+    }
+    *json += "],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924095815681,\"max_id_str\":"
+             "\"505874924095815681\",\"next_results\":\"?max_id=505874915338104831&q=%E4%B8%80&count=100\","
+             "\"query\":\"%E4%B8%80\",\"count\":100,\"since_id\":0,\"since_id_str\":\"0\"}}";
+}
+
+// citm_catalog.json-like: maps keyed by numeric ids and arrays of small records, many keys and short integers
+static void GenCitm(std::string* json) {
+    uint64_t seed = 3;
+    *json += "{\"areaNames\":{";
+    for (int i = 0; i < 20; ++i) {
+        *json += (i > 0 ? ",\"" : "\"") + std::to_string(205705993 + i) + "\":\"Arri\\u00e8re-sc\\u00e8ne " +
+                 std::to_string(i) + "\"";
+    }
+    *json += "},\"events\":{";
+    for (int i = 0; i < 200; ++i) {
+        std::string id = std::to_string(138586341 + i * 4);
+        *json += (i > 0 ? ",\"" : "\"") + id + "\":{\"description\":null,\"id\":" + id + ",\"logo\":null,\"name\":\""
+                 "Event " + std::to_string(i) + "\",\"subTopicIds\":[337184269,337184283],\"subjectCode\":null,"
+                 "\"subtitle\":null,\"topicIds\":[324846099,107888604]}";
+    }
+    *json += "},\"performances\":[";
+    for (int i = 0; i < 1200; ++i) {
+        if (i > 0) json->push_back(',');
+        *json += "{\"eventId\":" + std::to_string(138586341 + i % 200 * 4) +
+                 ",\"id\":" + std::to_string(339887544 + i) +
+                 ",\"logo\":\"\\/images\\/UE0AAAAACEKo6QAAAAZDSVRN\",\"name\":null,\"prices\":[";
+        int prices = 1 + NextRandom(&seed) % 4;
+        for (int p = 0; p < prices; ++p) {
+            *json += (p > 0 ? ",{\"amount\":" : "{\"amount\":") + std::to_string(NextRandom(&seed) % 100000) +
+                     ",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":" + std::to_string(338937295 + p) + "}";
+        }
+        *json += "],\"seatCategories\":[";
+        for (int c = 0; c < prices; ++c) {
+            *json += (c > 0 ? ",{\"areas\":[" : "{\"areas\":[");
+            for (int a = 0; a < 3; ++a) {
+                *json += (a > 0 ? ",{\"areaId\":" : "{\"areaId\":") + std::to_string(205705999 + a) +
+                         ",\"blockIds\":[]}";
+            }
+            *json += "],\"seatCategoryId\":" + std::to_string(338937295 + c) + "}";
+        }
+        *json += "],\"seatMapImage\":null,\"start\":" + std::to_string(1372701600000ULL + i * 86400000ULL) +
+                 ",\"venueCode\":\"PLEYEL_PLEYEL\"}";
+    }
+    *json += "],\"venueNames\":{\"PLEYEL_PLEYEL\":\"Salle Pleyel\"}}";
+}
+
+// `count` chains of `depth` levels, objects and arrays in turn: [{"a":[{"a":[... 0 ...]}]}, ...]
+static void GenDeep(std::string* json, int count, int depth) {
+    json->push_back('[');
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) json->push_back(',');
+        for (int d = 0; d < depth; ++d) *json += d % 2 ? "[" : "{\"a\":";
+        *json += std::to_string(i);
+        for (int d = depth - 1; d >= 0; --d) json->push_back(d % 2 ? ']' : '}');
+    }
+    json->push_back(']');
+}
+
+// with a cache, the cache is trained by the first iteration and reused by the others
+// with an arena every parse allocates from it and the arena is released after the tree is gone, like one per request
+static void BenchParse(const char* name, const std::string& json, int iterations, LitShapeCache* cache = nullptr,
+                       LitMonotonicResource* arena = nullptr) {
+    LitJson lit(arena != nullptr ? arena : lit_get_default_resource());
+    size_t count = 0, bytes = 0;
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        {
+            LitValue t;
+            size_t c0 = alloc_count, b0 = alloc_bytes;
+            auto start = std::chrono::steady_clock::now();
+            if (lit.LitParse(&t, json.data(), json.size(), cache) != LIT_PARSE_OK) {
+                std::cerr << name << ": parse failed" << std::endl;
+                exit(1);
+            }
+            auto stop = std::chrono::steady_clock::now();
+            count += alloc_count - c0;
+            bytes += alloc_bytes - b0;
+            elapsed += std::chrono::duration<double>(stop - start).count();
+        }
+        if (arena != nullptr) arena->LitRelease();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s %10zu allocs/parse %12zu bytes allocated/parse\n", name, json.size(),
+           json.size() * iterations / elapsed / 1e6, count / iterations, bytes / iterations);
+}
+
+// aggregates without building a tree: sums the numbers and the string bytes
+struct SumHandler : LitBaseHandler {
+    bool Double(double d) {
+        sum += d;
+        return true;
+    }
+    bool Int64(int64_t i) {
+        sum += static_cast<double>(i);
+        return true;
+    }
+    bool Uint64(uint64_t u) {
+        sum += static_cast<double>(u);
+        return true;
+    }
+    bool String(const char*, size_t len) {
+        bytes += len;
+        return true;
+    }
+
+    double sum = 0.0;
+    size_t bytes = 0;
+};
+
+static void BenchReader(const char* name, const std::string& json, int iterations) {
+    LitReader<SumHandler> reader;
+    size_t count = 0;
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        SumHandler h;
+        size_t c0 = alloc_count;
+        auto start = std::chrono::steady_clock::now();
+        if (reader.LitParse(json.c_str(), &h) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        count += alloc_count - c0;
+        elapsed += std::chrono::duration<double>(stop - start).count();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s %10zu allocs/parse\n", name, json.size(),
+           json.size() * iterations / elapsed / 1e6, count / iterations);
+}
+
+// the same text fed to LitPushParser in chunks of `chunk` bytes
+static void BenchPush(const char* name, const std::string& json, size_t chunk, int iterations) {
+    LitPushParser push;
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        LitValue t;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t j = 0; j < json.size(); j += chunk) push.Feed(json.data() + j, std::min(chunk, json.size() - j));
+        if (push.Finish(&t) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        elapsed += std::chrono::duration<double>(stop - start).count();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s\n", name, json.size(), json.size() * iterations / elapsed / 1e6);
+}
+
+// LitParseFile on a temporary file against reading the file into a string and parsing that
+static void BenchParseFile(const char* name, const std::string& json, int iterations) {
+    const char* path = "lit_benchmark.json";
+    FILE* f = fopen(path, "wb");
+    fwrite(json.data(), 1, json.size(), f);
+    fclose(f);
+
+    LitJson lit;
+    double mapped = 0.0, copied = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        LitValue t;
+        auto start = std::chrono::steady_clock::now();
+        if (lit.LitParseFile(&t, path) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        auto mid = std::chrono::steady_clock::now();
+        f = fopen(path, "rb");
+        std::string text(json.size(), '\0');
+        if (fread(&text[0], 1, text.size(), f) != text.size() || lit.LitParse(&t, text.c_str()) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        fclose(f);
+        auto stop = std::chrono::steady_clock::now();
+        mapped += std::chrono::duration<double>(mid - start).count();
+        copied += std::chrono::duration<double>(stop - mid).count();
+    }
+    remove(path);
+    printf("%-24s %10zu bytes %10.2f MB/s mmap %10.2f MB/s fread\n", name, json.size(),
+           json.size() * iterations / mapped / 1e6, json.size() * iterations / copied / 1e6);
+}
+
+static void BenchNdjson(const char* name, const std::string& json, unsigned threads, int iterations) {
+    LitNdjsonParser parser(threads);
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        size_t records = 0;
+        auto start = std::chrono::steady_clock::now();
+        ParseResultType res = parser.LitParse(json.data(), json.size(), [&records](LitNdjsonRecord* r) {
+            ++records;
+            return r->result == LIT_PARSE_OK;
+        });
+        auto stop = std::chrono::steady_clock::now();
+        if (res != LIT_PARSE_OK || records == 0) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        elapsed += std::chrono::duration<double>(stop - start).count();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s %4u threads\n", name, json.size(), json.size() * iterations / elapsed / 1e6,
+           parser.lit_get_threads());
+}
+
+// read 4 fields out of the payload: full parse + lookups against the lazy document
+static void BenchLazy(const char* name, const std::string& json, int iterations) {
+    LitJson lit;
+    LitLazyDocument doc;
+    double full = 0.0, lazy = 0.0, sum = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        LitValue v;
+        if (lit.LitParse(&v, json.data(), json.size()) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        sum += lit.lit_get_number(*lit.lit_find_object_value(v, "total", 5));
+        sum += lit.lit_get_number(*lit.lit_find_object_value(*lit.lit_find_object_value(v, "user", 4), "id", 2));
+        sum += lit.lit_get_string(*lit.lit_find_object_value(v, "request_id", 10)).size();
+        sum += lit.lit_get_number(*lit.lit_find_object_value(*lit.lit_find_object_value(v, "meta", 4), "version", 7));
+        auto mid = std::chrono::steady_clock::now();
+
+        if (doc.LitParse(json.data(), json.size()) != LIT_PARSE_OK) {
+            std::cerr << name << ": lazy parse failed" << std::endl;
+            exit(1);
+        }
+        LitLazyValue root = doc.lit_get_root();
+        double n = 0.0;
+        std::string s;
+        doc.lit_get_number(doc.lit_find_object_value(root, "total", 5), &n);
+        sum -= n;
+        doc.lit_get_number(doc.lit_find_object_value(doc.lit_find_object_value(root, "user", 4), "id", 2), &n);
+        sum -= n;
+        doc.lit_get_string(doc.lit_find_object_value(root, "request_id", 10), &s);
+        sum -= s.size();
+        doc.lit_get_number(doc.lit_find_object_value(doc.lit_find_object_value(root, "meta", 4), "version", 7), &n);
+        sum -= n;
+        auto stop = std::chrono::steady_clock::now();
+        full += std::chrono::duration<double>(mid - start).count();
+        lazy += std::chrono::duration<double>(stop - mid).count();
+    }
+    if (sum != 0.0) {
+        std::cerr << name << ": lazy and full parse disagree" << std::endl;
+        exit(1);
+    }
+    printf("%-24s %10zu bytes %10.2f us full %10.2f us lazy\n", name, json.size(), full / iterations * 1e6,
+           lazy / iterations * 1e6);
+}
+
+// sum "/items/*/price": the hand-written loop over keys, the compiled pointer on a parsed tree, and extraction
+// while parsing
+static void BenchPointer(const char* name, const std::string& json, int iterations) {
+    LitJson lit;
+    LitValue v;
+    if (lit.LitParse(&v, json.c_str()) != LIT_PARSE_OK) {
+        std::cerr << name << ": parse failed" << std::endl;
+        exit(1);
+    }
+    LitPointer pointer;
+    pointer.LitCompile("/items/*/price");
+    double loop = 0.0, compiled = 0.0, extract = 0.0;
+    bool same = true;
+    for (int i = 0; i < iterations; ++i) {
+        double expect = 0.0, sum = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t j = 0; j < lit.lit_get_object_size(v); ++j) {
+            if (lit.lit_get_object_key(v, j) != "items") continue;
+            LitValue& items = lit.lit_get_object_value(v, j);
+            for (size_t k = 0; k < lit.lit_get_array_size(items); ++k) {
+                LitValue& item = lit.lit_get_array_element(items, k);
+                for (size_t m = 0; m < lit.lit_get_object_size(item); ++m) {
+                    if (lit.lit_get_object_key(item, m) == "price") {
+                        expect += lit.lit_get_number(lit.lit_get_object_value(item, m));
+                    }
+                }
+            }
+            break;
+        }
+        auto mid = std::chrono::steady_clock::now();
+        std::vector<const LitValue*> all;
+        pointer.LitFindAll(v, &all);
+        for (const LitValue* p : all) sum += lit.lit_get_number(*p);
+        auto mid2 = std::chrono::steady_clock::now();
+        std::vector<LitValue> res;
+        if (pointer.LitExtract(json.c_str(), &res) != LIT_PARSE_OK) {
+            std::cerr << name << ": extract failed" << std::endl;
+            exit(1);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        loop += std::chrono::duration<double>(mid - start).count();
+        compiled += std::chrono::duration<double>(mid2 - mid).count();
+        extract += std::chrono::duration<double>(stop - mid2).count();
+        same = same && sum == expect && res.size() == all.size();
+    }
+    if (!same) {
+        std::cerr << name << ": results disagree" << std::endl;
+        exit(1);
+    }
+    printf("%-24s %10zu bytes %10.2f us loop %10.2f us pointer %10.2f us extract\n", name, json.size(),
+           loop / iterations * 1e6, compiled / iterations * 1e6, extract / iterations * 1e6);
+}
+
+enum StringifyTarget {
+    kStringifyString,  // LitStringify(v): sized by LitStringifyLength, one allocation
+    kStringifyGrow,    // appended to a std::string that grows as it goes, like LitStringify did before the pre-pass
+    kStringifySink     // streamed into a LitCallbackSink that only counts the bytes
+};
+
+static void BenchStringify(const char* name, const std::string& json, StringifyTarget target, int iterations) {
+    LitJson lit;
+    LitValue v;
+    if (lit.LitParse(&v, json.c_str()) != LIT_PARSE_OK) {
+        std::cerr << name << ": parse failed" << std::endl;
+        exit(1);
+    }
+    size_t count = 0, bytes = 0, out = 0;
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        size_t c0 = alloc_count, b0 = alloc_bytes;
+        auto start = std::chrono::steady_clock::now();
+        if (target == kStringifyString) {
+            out = lit.LitStringify(v).size();
+        } else {
+            // small chunks keep the growing string close to a string appended to piece by piece
+            size_t capacity = target == kStringifyGrow ? 64 : LitBufferedSink::kDefaultCapacity;
+            std::string res;
+            out = 0;
+            auto write = [&](const char* data, size_t len) {
+                if (target == kStringifyGrow) res.append(data, len);
+                out += len;
+                return true;
+            };
+            LitCallbackSink sink(write, capacity);
+            lit.LitStringify(v, &sink);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        count += alloc_count - c0;
+        bytes += alloc_bytes - b0;
+        elapsed += std::chrono::duration<double>(stop - start).count();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s %10zu allocs/call %12zu bytes allocated/call\n", name, out,
+           out * iterations / elapsed / 1e6, count / iterations, bytes / iterations);
+}
+
+static void BenchStringifyAll(const char* name, const std::string& json, int iterations) {
+    static const char* const kSuffix[] = {"", " grow", " sink"};
+    for (int t = kStringifyString; t <= kStringifySink; ++t) {
+        std::string label = std::string("stringify ") + name + kSuffix[t];
+        BenchStringify(label.c_str(), json, static_cast<StringifyTarget>(t), iterations);
+    }
+}
+
+// keyed lookups into one large object, a scan over lit_get_object_key against lit_find_object_value
+static void BenchFind(const char* name, const std::string& json, int lookups) {
+    LitJson lit;
+    LitValue v;
+    if (lit.LitParse(&v, json.c_str()) != LIT_PARSE_OK) {
+        std::cerr << name << ": parse failed" << std::endl;
+        exit(1);
+    }
+    size_t size = lit.lit_get_object_size(v);
+    std::vector<std::string> keys;
+    for (int i = 0; i < lookups; ++i) keys.push_back("feature.flag." + std::to_string((i * 7919) % (size + size / 8)));
+
+    double sum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& key : keys) {
+        for (size_t j = 0; j < size; ++j) {
+            if (lit.lit_get_object_key(v, j) == key) {
+                sum += lit.lit_get_number(lit.lit_get_object_value(v, j));
+                break;
+            }
+        }
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (const std::string& key : keys) {
+        const LitValue* p = lit.lit_find_object_value(v, key.c_str(), key.size());
+        if (p != nullptr) sum -= lit.lit_get_number(*p);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    if (sum != 0.0) {
+        std::cerr << name << ": lookups disagree" << std::endl;
+        exit(1);
+    }
+    printf("%-24s %10zu keys %10.1f ns/scan %10.1f ns/find\n", name, size,
+           std::chrono::duration<double>(mid - start).count() / lookups * 1e9,
+           std::chrono::duration<double>(stop - mid).count() / lookups * 1e9);
+}
+
+static void BenchDocument(const char* name, const std::string& json, int iterations) {
+    LitDocument doc;
+    size_t count = 0, bytes = 0;
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        size_t c0 = alloc_count, b0 = alloc_bytes;
+        auto start = std::chrono::steady_clock::now();
+        if (doc.LitParse(json.c_str()) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        count += alloc_count - c0;
+        bytes += alloc_bytes - b0;
+        elapsed += std::chrono::duration<double>(stop - start).count();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s %10zu allocs/parse %12zu bytes allocated/parse\n", name, json.size(),
+           json.size() * iterations / elapsed / 1e6, count / iterations, bytes / iterations);
+}
+
+static void BenchDocumentInsitu(const char* name, const std::string& json, int iterations) {
+    LitDocument doc;
+    std::vector<char> text(json.c_str(), json.c_str() + json.size() + 1);
+    double elapsed = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        // the buffer is decoded in place, restore it outside the timed region
+        memcpy(text.data(), json.c_str(), json.size() + 1);
+        auto start = std::chrono::steady_clock::now();
+        if (doc.LitParseInsitu(text.data()) != LIT_PARSE_OK) {
+            std::cerr << name << ": parse failed" << std::endl;
+            exit(1);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        elapsed += std::chrono::duration<double>(stop - start).count();
+    }
+    printf("%-24s %10zu bytes %10.2f MB/s\n", name, json.size(), json.size() * iterations / elapsed / 1e6);
+}
+
+// the tree and the tape side by side: parse, sum every number in a full walk, and drop the result
+static double SumTree(LitJson& lit, const LitValue& v) {
+    switch (lit.lit_get_type(v)) {
+        case LIT_NUMBER: return lit.lit_get_number(v);
+        case LIT_ARRAY: {
+            double sum = 0.0;
+            for (size_t i = 0; i < lit.lit_get_array_size(v); ++i) sum += SumTree(lit, lit.lit_get_array_element(v, i));
+            return sum;
+        }
+        case LIT_OBJECT: {
+            double sum = 0.0;
+            for (size_t i = 0; i < lit.lit_get_object_size(v); ++i) sum += SumTree(lit, lit.lit_get_object_value(v, i));
+            return sum;
+        }
+        default: return 0.0;
+    }
+}
+
+static double SumTape(const LitTapeDocument& doc, const LitTapeValue& v) {
+    double sum = 0.0;
+    switch (doc.lit_get_type(v)) {
+        case LIT_NUMBER: return doc.lit_get_number(v);
+        case LIT_ARRAY:
+            for (LitTapeValue e = doc.lit_get_first_element(v); e.lit_is_valid(); e = doc.lit_get_next_element(e)) {
+                sum += SumTape(doc, e);
+            }
+            return sum;
+        case LIT_OBJECT:
+            for (LitTapeValue k = doc.lit_get_first_member(v); k.lit_is_valid(); k = doc.lit_get_next_member(k)) {
+                sum += SumTape(doc, doc.lit_get_member_value(k));
+            }
+            return sum;
+        default: return 0.0;
+    }
+}
+
+static void BenchTape(const char* name, const std::string& json, int iterations) {
+    LitJson lit;
+    double parse[2] = {0.0, 0.0}, walk[2] = {0.0, 0.0}, drop[2] = {0.0, 0.0};
+    size_t count[2] = {0, 0};
+    for (int i = 0; i < iterations; ++i) {
+        size_t c0 = alloc_count;
+        auto t0 = std::chrono::steady_clock::now(), t1 = t0, t2 = t0;
+        double expect = 0.0;
+        {
+            LitValue v;
+            if (lit.LitParse(&v, json.c_str()) != LIT_PARSE_OK) {
+                std::cerr << name << ": parse failed" << std::endl;
+                exit(1);
+            }
+            t1 = std::chrono::steady_clock::now();
+            expect = SumTree(lit, v);
+            t2 = std::chrono::steady_clock::now();
+        }
+        auto t3 = std::chrono::steady_clock::now(), t4 = t3, t5 = t3;
+        size_t c1 = alloc_count;
+        double sum = 0.0;
+        {
+            // a fresh document each round, so the tape pays for its allocations like the tree does
+            LitTapeDocument doc;
+            if (doc.LitParse(json.c_str()) != LIT_PARSE_OK) {
+                std::cerr << name << ": tape parse failed" << std::endl;
+                exit(1);
+            }
+            t4 = std::chrono::steady_clock::now();
+            sum = SumTape(doc, doc.lit_get_root());
+            t5 = std::chrono::steady_clock::now();
+        }
+        auto t6 = std::chrono::steady_clock::now();
+        if (sum != expect) {
+            std::cerr << name << ": tree and tape disagree" << std::endl;
+            exit(1);
+        }
+        count[0] += c1 - c0;
+        count[1] += alloc_count - c1;
+        parse[0] += std::chrono::duration<double>(t1 - t0).count();
+        walk[0] += std::chrono::duration<double>(t2 - t1).count();
+        drop[0] += std::chrono::duration<double>(t3 - t2).count();
+        parse[1] += std::chrono::duration<double>(t4 - t3).count();
+        walk[1] += std::chrono::duration<double>(t5 - t4).count();
+        drop[1] += std::chrono::duration<double>(t6 - t5).count();
+    }
+    static const char* kKinds[] = {"tree", "tape"};
+    for (int k = 0; k < 2; ++k) {
+        std::string label = std::string(name) + " " + kKinds[k];
+        printf("%-24s %10zu bytes %10.2f us parse %10.2f us walk %10.2f us free %10zu allocs\n", label.c_str(),
+               json.size(), parse[k] / iterations * 1e6, walk[k] / iterations * 1e6, drop[k] / iterations * 1e6,
+               count[k] / iterations);
+    }
+}
+
+// the same tree as text, MessagePack and CBOR: payload size and the time to encode and to decode it
+static void BenchBinary(const char* name, const std::string& json, int iterations) {
+    LitJson lit;
+    LitValue v;
+    if (lit.LitParse(&v, json.c_str()) != LIT_PARSE_OK) {
+        std::cerr << name << ": parse failed" << std::endl;
+        exit(1);
+    }
+    static const char* const kFormat[] = {"json", "msgpack", "cbor"};
+    for (int f = 0; f < 3; ++f) {
+        std::string bytes;
+        double encode = 0.0, decode = 0.0;
+        for (int i = 0; i < iterations; ++i) {
+            LitValue t;
+            auto start = std::chrono::steady_clock::now();
+            bytes = f == 0 ? lit.LitStringify(v) : f == 1 ? lit.LitEncodeMsgPack(v) : lit.LitEncodeCbor(v);
+            auto mid = std::chrono::steady_clock::now();
+            ParseResultType r = f == 0   ? lit.LitParse(&t, bytes.data(), bytes.size())
+                                : f == 1 ? lit.LitParseMsgPack(&t, bytes.data(), bytes.size())
+                                         : lit.LitParseCbor(&t, bytes.data(), bytes.size());
+            auto stop = std::chrono::steady_clock::now();
+            if (r != LIT_PARSE_OK || (i == 0 && lit.LitStringify(t) != lit.LitStringify(v))) {
+                std::cerr << name << ": " << kFormat[f] << " round trip failed" << std::endl;
+                exit(1);
+            }
+            encode += std::chrono::duration<double>(mid - start).count();
+            decode += std::chrono::duration<double>(stop - mid).count();
+        }
+        std::string label = std::string(name) + " " + kFormat[f];
+        printf("%-24s %10zu bytes %10.2f us encode %10.2f us decode\n", label.c_str(), bytes.size(),
+               encode / iterations * 1e6, decode / iterations * 1e6);
+    }
+}
+
+// the corpus suite: each document parsed and stringified until kCorpusRuns runs and kCorpusSeconds have passed.
+// Throughput comes from the fastest run, the least disturbed one. peak is the most memory live at once above what
+// was live before the call, for a parse that includes the tree it returns.
+static const int kCorpusRuns = 5;
+static const double kCorpusSeconds = 0.5;
+
+struct CorpusStats {
+    int runs = 0;
+    double total = 0.0, best = 0.0;
+    size_t allocs = 0, peak = 0;
+};
+
+static size_t CountValues(const LitJson& lit, const LitValue& v) {
+    size_t count = 1;
+    if (lit.lit_get_type(v) == LIT_ARRAY) {
+        for (size_t i = 0; i < lit.lit_get_array_size(v); ++i) {
+            count += CountValues(lit, lit.lit_get_array_element(v, i));
+        }
+    } else if (lit.lit_get_type(v) == LIT_OBJECT) {
+        for (size_t i = 0; i < lit.lit_get_object_size(v); ++i) {
+            count += CountValues(lit, lit.lit_get_object_value(v, i));
+        }
+    }
+    return count;
+}
+
+// done() runs after the clock stops, to free what run() built
+template <typename F, typename G>
+static CorpusStats MeasureCorpus(F run, G done) {
+    CorpusStats stats;
+    while (stats.runs < kCorpusRuns || stats.total < kCorpusSeconds) {
+        size_t c0 = alloc_count, live = alloc_live;
+        alloc_peak = live;
+        auto start = std::chrono::steady_clock::now();
+        run();
+        auto stop = std::chrono::steady_clock::now();
+        stats.allocs = alloc_count - c0;
+        stats.peak = std::max(stats.peak, alloc_peak - live);
+        done();
+        double elapsed = std::chrono::duration<double>(stop - start).count();
+        stats.best = stats.runs == 0 ? elapsed : std::min(stats.best, elapsed);
+        stats.total += elapsed;
+        ++stats.runs;
+    }
+    return stats;
+}
+
+static void ReportCorpus(const char* name, const char* op, size_t bytes, size_t values, const CorpusStats& stats,
+                         bool csv) {
+    double mbs = bytes / stats.best / 1e6, ns = stats.best / values * 1e9;
+    if (csv) {
+        printf("%s,%s,%zu,%zu,%d,%.6f,%.2f,%.2f,%zu,%zu\n", name, op, bytes, values, stats.runs, stats.best * 1e3, mbs,
+               ns, stats.allocs, stats.peak);
+    } else {
+        std::string label = std::string(op) + " " + name;
+        printf("%-24s %10zu bytes %10.2f MB/s %8.2f ns/value %10zu allocs %12zu bytes peak\n", label.c_str(), bytes,
+               mbs, ns, stats.allocs, stats.peak);
+    }
+}
+
+static void BenchCorpus(const char* name, const std::string& json, bool csv) {
+    LitJson lit;
+    LitValue v;
+    if (lit.LitParse(&v, json.data(), json.size()) != LIT_PARSE_OK) {
+        std::cerr << name << ": parse failed" << std::endl;
+        exit(1);
+    }
+    size_t values = CountValues(lit, v), out = 0;
+    LitValue t;
+    std::string text;
+    CorpusStats parse = MeasureCorpus([&]() { lit.LitParse(&t, json.data(), json.size()); },
+                                      [&]() { lit.lit_set_null(&t); });
+    CorpusStats stringify = MeasureCorpus([&]() { text = lit.LitStringify(v); }, [&]() {
+        out = text.size();
+        std::string().swap(text);
+    });
+    ReportCorpus(name, "parse", json.size(), values, parse, csv);
+    ReportCorpus(name, "stringify", out, values, stringify, csv);
+}
+
+static bool ReadFile(const char* path, std::string* text) {
+    FILE* f = fopen(path, "rb");
+    if (f == nullptr) return false;
+    char buff[64 * 1024];
+    size_t n;
+    while ((n = fread(buff, 1, sizeof(buff), f)) > 0) text->append(buff, n);
+    fclose(f);
+    return true;
+}
+
+// the standard corpus followed by the files named on the command line
+static void BenchCorpusAll(const std::vector<const char*>& files, bool csv) {
+    std::vector<std::pair<std::string, std::string>> corpus(5);
+    corpus[0].first = "canada";
+    GenCanada(&corpus[0].second);
+    corpus[1].first = "twitter";
+    GenTwitter(&corpus[1].second);
+    corpus[2].first = "citm";
+    GenCitm(&corpus[2].second);
+    corpus[3].first = "strings";
+    GenLongStrings(&corpus[3].second, 200, 10000);
+    corpus[4].first = "deep";
+    GenDeep(&corpus[4].second, 2000, 100);
+    for (const char* path : files) {
+        corpus.emplace_back(path, std::string());
+        if (!ReadFile(path, &corpus.back().second)) {
+            std::cerr << path << ": cannot read" << std::endl;
+            exit(1);
+        }
+    }
+    if (csv) printf("corpus,op,bytes,values,runs,best_ms,mb_per_s,ns_per_value,allocs,peak_bytes\n");
+    for (const auto& doc : corpus) BenchCorpus(doc.first.c_str(), doc.second, csv);
+}
+
+// Benchmark             every benchmark, the corpus suite last
+// Benchmark --corpus    only the corpus suite
+// Benchmark --csv       only the corpus suite as CSV, to keep and compare runs
+// file arguments are parsed and stringified after the standard corpus
+int main(int argc, char** argv) {
+    bool corpus_only = false, csv = false;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--corpus") == 0) {
+            corpus_only = true;
+        } else if (strcmp(argv[i], "--csv") == 0) {
+            corpus_only = csv = true;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+    if (corpus_only) {
+        BenchCorpusAll(files, csv);
+        return 0;
+    }
+
+    int id = 0;
+    std::string nested;
+    GenNested(&nested, 5, &id);
+
+    BenchParse("parse nested", nested, 20);
+    BenchParse("parse nested pretty", Pretty(nested), 20);
+    BenchDocument("document nested", nested, 20);
+    BenchDocumentInsitu("document insitu nested", nested, 20);
+    BenchReader("reader nested", nested, 20);
+    BenchPush("push nested 16k chunks", nested, 16 * 1024, 20);
+    BenchPush("push nested 1k chunks", nested, 1024, 20);
+    BenchStringifyAll("nested", nested, 20);
+    BenchBinary("binary nested", nested, 20);
+    BenchTape("tape nested", nested, 20);
+
+    std::string numbers;
+    GenNumbers(&numbers, 200000);
+    BenchParse("parse numbers", numbers, 10);
+    BenchDocument("document numbers", numbers, 10);
+    BenchStringifyAll("numbers", numbers, 10);
+    BenchBinary("binary numbers", numbers, 10);
+    BenchTape("tape numbers", numbers, 10);
+    BenchReader("reader numbers", numbers, 10);
+    BenchPush("push numbers 16k chunks", numbers, 16 * 1024, 10);
+
+    std::string integers;
+    GenIntegers(&integers, 200000);
+    BenchParse("parse integers", integers, 10);
+    BenchDocument("document integers", integers, 10);
+    BenchStringifyAll("integers", integers, 10);
+
+    static const int kConfigSizes[] = {8, 16, 64, 5000};
+    for (int size : kConfigSizes) {
+        std::string config;
+        GenConfig(&config, size);
+        std::string name = "find config " + std::to_string(size);
+        BenchFind(name.c_str(), config, 100000);
+    }
+    std::string config;
+    GenConfig(&config, 100000);
+    BenchStringifyAll("config 100000", config, 10);
+
+    std::string payload;
+    GenPayload(&payload);
+    BenchLazy("lazy 4 fields", payload, 2000);
+    BenchPointer("pointer items/*/price", payload, 2000);
+    LitShapeCache cache;
+    BenchParse("parse payload", payload, 2000);
+    BenchParse("parse payload shapes", payload, 2000, &cache);
+    LitMonotonicResource arena;
+    BenchParse("parse payload arena", payload, 2000, nullptr, &arena);
+
+    std::string records;
+    GenRecords(&records, 100000);
+    BenchParse("parse records", records, 10);
+    BenchParse("parse records shapes", records, 10, &cache);
+    BenchParse("parse records arena", records, 10, nullptr, &arena);
+
+    std::string ndjson;
+    GenNdjson(&ndjson, 500000);
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads < hardware; threads *= 2) {
+        std::string name = "ndjson " + std::to_string(threads) + " threads";
+        BenchNdjson(name.c_str(), ndjson, threads, 5);
+    }
+    BenchNdjson("ndjson all threads", ndjson, 0, 5);
+
+    std::string strings;
+    GenLongStrings(&strings, 200, 10000);
+    BenchParseFile("parse file strings", strings, 20);
+    static const char* kLevelNames[] = {"scalar", "sse2", "avx2"};
+    LitSimdLevel best = lit_get_simd_level();
+    for (int level = LIT_SIMD_NONE; level <= best; ++level) {
+        lit_set_simd_level(static_cast<LitSimdLevel>(level));
+        std::string name = std::string("parse strings ") + kLevelNames[level];
+        BenchParse(name.c_str(), strings, 20);
+        name = std::string("document strings ") + kLevelNames[level];
+        BenchDocument(name.c_str(), strings, 20);
+    }
+    lit_set_simd_level(best);
+
+    BenchCorpusAll(files, false);
+    return 0;
+}
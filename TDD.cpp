@@ -1,12 +1,29 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <thread>
 
+#include "LitDecode.h"
+#include "LitDocument.h"
+#include "LitLazy.h"
+#include "LitMemory.h"
+#include "LitNdjson.h"
+#include "LitPointer.h"
+#include "LitPushParser.h"
+#include "LitReader.h"
+#include "LitShapeCache.h"
+#include "LitSink.h"
+#include "LitStats.h"
+#include "LitTape.h"
 #include "litjson.h"
 
 static int main_ret = 0;
 static int test_count = 0;
 static int test_pass = 0;
-static LitJson lit;
+static const LitJson lit;
 
 #define CHECK_EQ(expect, actual) CheckEquality(expect, actual, __FILE__, __LINE__)
 #define CHECK_ERROR(error, json) CheckError(error, json, __FILE__, __LINE__)
@@ -24,6 +41,11 @@ static void CheckEquality(T expect, T actual, const char *file_name, int line_nu
     }
 }
 
+static void CheckEquality(const std::string &expect, const LitValue::String &actual, const char *file_name,
+                          int line_num) {
+    CheckEquality(expect, std::string(actual.data(), actual.size()), file_name, line_num);
+}
+
 static void CheckError(ParseResultType error, const char *json, const char *file_name, int line_num) {
     LitValue v;
     lit.lit_set_boolean(&v, false);
@@ -100,6 +122,63 @@ static void TestParseNumber() {
     CHECK_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
     CHECK_NUMBER(1.7976931348623157e+308, "1.7976931348623157e+308");  // maximum normal positive
     CHECK_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
+
+    // rounding edge cases, short inputs take the exact fast path, the rest Eisel-Lemire or the decimal fallback
+    CHECK_NUMBER(9007199254740992.0, "9007199254740993");  // halfway between doubles, ties to even
+    CHECK_NUMBER(9007199254740994.0, "9007199254740993.0000000000000001");
+    CHECK_NUMBER(0.1, "0.1000000000000000055511151231257827021181583404541015625");
+    CHECK_NUMBER(0.3, "0.299999999999999988897769753748434595763683319091796875");
+    CHECK_NUMBER(1e23, "1e23");
+    CHECK_NUMBER(1e23, "100000000000000000000000");
+    CHECK_NUMBER(123456789012345678901234567890.0, "123456789012345678901234567890");
+    CHECK_NUMBER(1.0, "1.00000000000000011102230246251565404236316680908203125");  // exactly halfway
+    CHECK_NUMBER(1.0000000000000002, "1.00000000000000011102230246251565404236316680908203126");
+    CHECK_NUMBER(0.0, "2.4703282292062327e-324");  // just below half of the minimum denormal
+    CHECK_NUMBER(4.9406564584124654e-324, "2.4703282292062328e-324");
+    CHECK_NUMBER(2.2250738585072011e-308, "2.22507385850720113605740979670913197593481954635164564e-308");
+    CHECK_NUMBER(1e-300, ("0." + std::string(299, '0') + "1").c_str());
+    CHECK_NUMBER(1.7976931348623157e+308, "1.7976931348623158e+308");
+}
+
+static void TestParseInteger() {
+    LitValue v;
+
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "0"));
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(v));
+    CHECK_EQ(static_cast<int64_t>(0), lit.lit_get_int64(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "-123"));
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(v));
+    CHECK_EQ(static_cast<int64_t>(-123), lit.lit_get_int64(v));
+
+    // exact beyond 2^53
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "9007199254740993"));
+    CHECK_EQ(static_cast<int64_t>(9007199254740993LL), lit.lit_get_int64(v));
+    CHECK_EQ(static_cast<uint64_t>(9007199254740993ULL), lit.lit_get_uint64(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "9223372036854775807"));
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(v));
+    CHECK_EQ(INT64_MAX, lit.lit_get_int64(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "-9223372036854775808"));
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(v));
+    CHECK_EQ(INT64_MIN, lit.lit_get_int64(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "9223372036854775808"));
+    CHECK_EQ(LIT_NUMBER_UINT64, lit.lit_get_number_type(v));
+    CHECK_EQ(static_cast<uint64_t>(9223372036854775808ULL), lit.lit_get_uint64(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "18446744073709551615"));
+    CHECK_EQ(LIT_NUMBER_UINT64, lit.lit_get_number_type(v));
+    CHECK_EQ(UINT64_MAX, lit.lit_get_uint64(v));
+
+    // out of range, fraction, exponent and -0 are doubles
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "18446744073709551616"));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, lit.lit_get_number_type(v));
+    CHECK_EQ(18446744073709551616.0, lit.lit_get_number(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "-9223372036854775809"));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, lit.lit_get_number_type(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "1.0"));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, lit.lit_get_number_type(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "1e2"));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, lit.lit_get_number_type(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "-0"));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, lit.lit_get_number_type(v));
 }
 
 static void TestParseString() {
@@ -115,6 +194,23 @@ static void TestParseString() {
     CHECK_STRING("\xF0\x9D\x84\x9E", "\"\\ud834\\udd1e\"");
 }
 
+static void TestParseLongString() {
+    // put the character that stops the scan at every offset of a vector block, for every scanner
+    for (int level = LIT_SIMD_NONE; level <= LIT_SIMD_AVX2; ++level) {
+        LitSimdLevel saved = lit_get_simd_level();
+        lit_set_simd_level(static_cast<LitSimdLevel>(level));
+        for (int len = 0; len < 80; ++len) {
+            std::string plain(len, 'x');
+            CHECK_STRING(plain + "\n" + plain, ("\"" + plain + "\\n" + plain + "\"").c_str());
+            CHECK_ERROR(LIT_PARSE_MISS_QUOTATION_MARK, ("\"" + plain).c_str());
+            CHECK_ERROR(LIT_PARSE_INVALID_STRING_CHAR, ("\"" + plain + "\x1f\"").c_str());
+        }
+        CHECK_STRING("\xE2\x82\xAC\xF0\x9D\x84\x9E abcdefghijklmnopqrstuvwxyz\x7F",
+                     "\"\xE2\x82\xAC\xF0\x9D\x84\x9E abcdefghijklmnopqrstuvwxyz\x7F\"");
+        lit_set_simd_level(saved);
+    }
+}
+
 static void TestParseArray() {
     LitValue v;
 
@@ -249,6 +345,8 @@ static void TestParseRootNotSingular() {
 static void TestParseNumberTooBig() {
     CHECK_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "1e309");
     CHECK_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "-1e309");
+    CHECK_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "1.7976931348623159e+308");
+    CHECK_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "1e99999999999999999999");
 }
 
 static void TestParseMissingQuotationMark() {
@@ -322,6 +420,55 @@ static void TestParseMissCommaOrCurlyBracket() {
     CHECK_ERROR(LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":{}");
 }
 
+static void TestParseDepthExceeded() {
+    const size_t depth = LitJson::kDefaultMaxDepth;
+    CHECK_EQ(depth, lit.lit_get_max_depth());
+    std::string arrays = std::string(depth, '[') + std::string(depth, ']');
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, arrays.c_str()));
+    CHECK_ERROR(LIT_PARSE_DEPTH_EXCEEDED, ("[" + arrays + "]").c_str());
+    std::string objects;
+    for (size_t i = 0; i < depth; ++i) objects += "{\"a\":";
+    objects += "1" + std::string(depth, '}');
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, objects.c_str()));
+    CHECK_ERROR(LIT_PARSE_DEPTH_EXCEEDED, ("[" + objects + "]").c_str());
+    // the limit is hit before the text is read to its end
+    CHECK_ERROR(LIT_PARSE_DEPTH_EXCEEDED, std::string(1000000, '[').c_str());
+
+    LitJson shallow;
+    shallow.lit_set_max_depth(2);
+    CHECK_EQ(LIT_PARSE_OK, shallow.LitParse(&v, "[[1],{\"a\":2},[]]"));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, shallow.LitParse(&v, "[[[1]]]"));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, shallow.LitParse(&v, "{\"a\":[{}]}"));
+    // the stack is left empty after an error
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, shallow.LitParse(&v, "[[1 2]]"));
+    CHECK_EQ(LIT_PARSE_OK, shallow.LitParse(&v, "[[3]]"));
+    CHECK_EQ(std::string("[[3]]"), lit.LitStringify(v));
+    shallow.lit_set_max_depth(0);
+    CHECK_EQ(LIT_PARSE_OK, shallow.LitParse(&v, "\"scalar\""));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, shallow.LitParse(&v, "[]"));
+
+    // binary data nests the same, CBOR tags count as a level
+    shallow.lit_set_max_depth(2);
+    CHECK_EQ(LIT_PARSE_OK, shallow.LitParseMsgPack(&v, "\x91\x91\x01", 3));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, shallow.LitParseMsgPack(&v, "\x91\x91\x91\x01", 4));
+    CHECK_EQ(LIT_PARSE_OK, shallow.LitParseCbor(&v, "\x81\xC0\x01", 3));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, shallow.LitParseCbor(&v, "\xC0\xC0\xC0\x01", 4));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+
+    // far past what recursion would survive on a small thread stack
+    LitJson deep;
+    deep.lit_set_max_depth(10000);
+    std::string nested = std::string(10000, '[') + "7" + std::string(10000, ']');
+    CHECK_EQ(LIT_PARSE_OK, deep.LitParse(&v, nested.c_str()));
+    const LitValue *e = &v;
+    size_t levels = 0;
+    for (; lit.lit_get_type(*e) == LIT_ARRAY; ++levels) e = &lit.lit_get_array_element(*e, 0);
+    CHECK_EQ(static_cast<size_t>(10000), levels);
+    CHECK_EQ(7.0, lit.lit_get_number(*e));
+}
+
 static void TestAccessNull() {
     LitValue v;
     lit.lit_set_string(&v, "access null");
@@ -343,6 +490,21 @@ static void TestAccessNumber() {
     lit.lit_set_string(&v, "access number");
     lit.lit_set_number(&v, 100.1);
     CHECK_EQ(LIT_NUMBER, lit.lit_get_type(v));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, lit.lit_get_number_type(v));
+
+    lit.lit_set_int64(&v, -42);
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(v));
+    CHECK_EQ(static_cast<int64_t>(-42), lit.lit_get_int64(v));
+    CHECK_EQ(-42.0, lit.lit_get_number(v));
+
+    // uint64 only holds what int64 cannot
+    lit.lit_set_uint64(&v, 42);
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(v));
+    CHECK_EQ(static_cast<uint64_t>(42), lit.lit_get_uint64(v));
+    lit.lit_set_uint64(&v, UINT64_MAX);
+    CHECK_EQ(LIT_NUMBER_UINT64, lit.lit_get_number_type(v));
+    LitValue t(v);
+    CHECK_EQ(UINT64_MAX, lit.lit_get_uint64(t));
 }
 
 static void TestAccessString() {
@@ -352,15 +514,815 @@ static void TestAccessString() {
     CHECK_EQ(LIT_STRING, lit.lit_get_type(v));
 }
 
+static void TestAccessObjectFind() {
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "{\"a\":1,\"b\":2,\"a\":3,\"\":4}"));
+    CHECK_EQ(static_cast<size_t>(0), lit.lit_find_object_index(v, "a", 1));  // the first of duplicate keys
+    CHECK_EQ(static_cast<size_t>(3), lit.lit_find_object_index(v, "", 0));
+    CHECK_EQ(LIT_KEY_NOT_EXIST, lit.lit_find_object_index(v, "c", 1));
+    CHECK_EQ(LIT_KEY_NOT_EXIST, lit.lit_find_object_index(v, "ab", 2));
+    CHECK_EQ(2.0, lit.lit_get_number(*lit.lit_find_object_value(v, "b", 1)));
+    CHECK_EQ(true, lit.lit_find_object_value(v, "c", 1) == nullptr);
+
+    // large objects go through the hash index, the member order stays the insertion order
+    std::string json = "{";
+    for (int i = 0; i < 1000; ++i) json += (i > 0 ? ",\"k" : "\"k") + std::to_string(i) + "\":" + std::to_string(i);
+    json += ",\"k7\":-1}";
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json.c_str()));
+    for (int i = 0; i < 1000; ++i) {
+        std::string key = "k" + std::to_string(i);
+        CHECK_EQ(static_cast<size_t>(i), lit.lit_find_object_index(v, key.c_str(), key.size()));
+    }
+    CHECK_EQ(std::string("k999"), lit.lit_get_object_key(v, 999));
+    CHECK_EQ(LIT_KEY_NOT_EXIST, lit.lit_find_object_index(v, "k1000", 5));
+    CHECK_EQ(LIT_KEY_NOT_EXIST, lit.lit_find_object_index(v, "k7\0", 3));
+
+    // copies and reassigned objects do not reuse a stale index
+    LitValue t(v);
+    CHECK_EQ(static_cast<size_t>(500), lit.lit_find_object_index(t, "k500", 4));
+    LitValue::Obj o(20);
+    for (int i = 0; i < 20; ++i) o[i].first = ("n" + std::to_string(19 - i)).c_str();
+    lit.lit_set_object(&v, std::move(o));
+    CHECK_EQ(LIT_KEY_NOT_EXIST, lit.lit_find_object_index(v, "k0", 2));
+    CHECK_EQ(static_cast<size_t>(19), lit.lit_find_object_index(v, "n0", 2));
+    v = t;
+    CHECK_EQ(static_cast<size_t>(0), lit.lit_find_object_index(v, "k0", 2));
+    LitValue m(std::move(v));
+    CHECK_EQ(static_cast<size_t>(1), lit.lit_find_object_index(m, "k1", 2));
+}
+
+static void TestAccessMove() {
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "[\"abc\",{\"k\":[1,2]}]"));
+
+    LitValue t(std::move(v));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+    CHECK_EQ(LIT_ARRAY, lit.lit_get_type(t));
+    CHECK_EQ(static_cast<size_t>(2), lit.lit_get_array_size(t));
+
+    // move a child over its own parent
+    t = std::move(lit.lit_get_array_element(t, 1));
+    CHECK_EQ(LIT_OBJECT, lit.lit_get_type(t));
+    CHECK_EQ(std::string("k"), lit.lit_get_object_key(t, 0));
+
+    std::string s("move string");
+    lit.lit_set_string(&v, std::move(s));
+    CHECK_EQ(std::string("move string"), lit.lit_get_string(v));
+
+    LitValue::Array a(3);
+    lit.lit_set_array(&v, std::move(a));
+    CHECK_EQ(static_cast<size_t>(3), lit.lit_get_array_size(v));
+}
+
+static void TestDocument() {
+    LitDocument doc;
+
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(" { \"n\" : null , \"s\" : \"a\\u0000b\" , \"a\" : [ true , 1.5 , [ ] , { } ] } "));
+    const LitNode& root = doc.lit_get_root();
+    CHECK_EQ(LIT_OBJECT, doc.lit_get_type(root));
+    CHECK_EQ(static_cast<size_t>(3), doc.lit_get_object_size(root));
+    CHECK_EQ(std::string("n"), std::string(doc.lit_get_object_key(root, 0), doc.lit_get_object_key_length(root, 0)));
+    CHECK_EQ(LIT_NULL, doc.lit_get_type(doc.lit_get_object_value(root, 0)));
+    const LitNode& s = doc.lit_get_object_value(root, 1);
+    CHECK_EQ(std::string("a\0b", 3), std::string(doc.lit_get_string(s), doc.lit_get_string_length(s)));
+    const LitNode& a = doc.lit_get_object_value(root, 2);
+    CHECK_EQ(static_cast<size_t>(4), doc.lit_get_array_size(a));
+    CHECK_EQ(true, doc.lit_get_boolean(doc.lit_get_array_element(a, 0)));
+    CHECK_EQ(1.5, doc.lit_get_number(doc.lit_get_array_element(a, 1)));
+    CHECK_EQ(static_cast<size_t>(0), doc.lit_get_array_size(doc.lit_get_array_element(a, 2)));
+    CHECK_EQ(static_cast<size_t>(0), doc.lit_get_object_size(doc.lit_get_array_element(a, 3)));
+
+    LitValue v;
+    doc.lit_to_value(root, &v);
+    CHECK_EQ(std::string("{\"n\":null,\"s\":\"a\\u0000b\",\"a\":[true,1.5,[],{}]}"), lit.LitStringify(v));
+
+    // integers stay exact through the document and lit_to_value
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse("[-9223372036854775808,18446744073709551615]"));
+    const LitNode& ints = doc.lit_get_root();
+    CHECK_EQ(INT64_MIN, doc.lit_get_int64(doc.lit_get_array_element(ints, 0)));
+    CHECK_EQ(LIT_NUMBER_UINT64, doc.lit_get_number_type(doc.lit_get_array_element(ints, 1)));
+    CHECK_EQ(UINT64_MAX, doc.lit_get_uint64(doc.lit_get_array_element(ints, 1)));
+    doc.lit_to_value(ints, &v);
+    CHECK_EQ(std::string("[-9223372036854775808,18446744073709551615]"), lit.LitStringify(v));
+
+    // same error reporting as LitJson, a failed parse leaves a null root
+    CHECK_EQ(LIT_PARSE_ROOT_NOT_SINGULAR, doc.LitParse("nulll"));
+    CHECK_EQ(LIT_NULL, doc.lit_get_type(doc.lit_get_root()));
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, doc.LitParse("[[1,2]"));
+    CHECK_EQ(LIT_PARSE_MISS_KEY, doc.LitParse("{\"a\":1,"));
+    CHECK_EQ(LIT_PARSE_INVALID_UNICODE_SURROGATE, doc.LitParse("[\"\\uD800\"]"));
+
+    // nesting is limited like in LitJson, hostile depth fails instead of overflowing the stack
+    CHECK_EQ(LitJson::kDefaultMaxDepth, doc.lit_get_max_depth());
+    std::string deep = std::string(LitJson::kDefaultMaxDepth, '[') + std::string(LitJson::kDefaultMaxDepth, ']');
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(deep.c_str()));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, doc.LitParse(("{\"a\":" + deep + "}").c_str()));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, doc.LitParse(std::string(1000000, '[').c_str()));
+    CHECK_EQ(LIT_NULL, doc.lit_get_type(doc.lit_get_root()));
+    doc.lit_set_max_depth(1);
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, doc.LitParse("[1,{}]"));
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse("{\"a\":1}"));
+    doc.lit_set_max_depth(LitJson::kDefaultMaxDepth);
+
+    // the arena is reused, a document of the same shape does not grow it
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse("[\"abc\",{\"k\":[1,2,3]}]"));
+    size_t capacity = doc.lit_get_arena_capacity();
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse("[\"def\",{\"k\":[4,5,6]}]"));
+    CHECK_EQ(capacity, doc.lit_get_arena_capacity());
+    doc.Release();
+    CHECK_EQ(static_cast<size_t>(0), doc.lit_get_arena_capacity());
+}
+
+static void TestDocumentInsitu() {
+    LitDocument doc;
+    char json[] = "{\"plain\":\"abc\",\"esc\\\"key\":\"x\\ty\\u20AC\",\"a\":[\"\",\"\\uD834\\uDD1E\"]}";
+    const char* begin = json;
+    const char* end = json + sizeof(json);
+
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParseInsitu(json));
+    const LitNode& root = doc.lit_get_root();
+    CHECK_EQ(static_cast<size_t>(3), doc.lit_get_object_size(root));
+
+    // keys and strings point into the source buffer, nothing was copied into the arena
+    const LitNode& plain = doc.lit_get_object_value(root, 0);
+    CHECK_EQ(true, doc.lit_get_string(plain) > begin && doc.lit_get_string(plain) < end);
+    CHECK_EQ(std::string("abc"), std::string(doc.lit_get_string(plain)));
+    CHECK_EQ(true, doc.lit_get_object_key(root, 1) > begin && doc.lit_get_object_key(root, 1) < end);
+    CHECK_EQ(std::string("esc\"key"), std::string(doc.lit_get_object_key(root, 1)));
+    const LitNode& esc = doc.lit_get_object_value(root, 1);
+    CHECK_EQ(std::string("x\ty\xE2\x82\xAC"), std::string(doc.lit_get_string(esc), doc.lit_get_string_length(esc)));
+    const LitNode& a = doc.lit_get_object_value(root, 2);
+    CHECK_EQ(static_cast<size_t>(0), doc.lit_get_string_length(doc.lit_get_array_element(a, 0)));
+    CHECK_EQ(std::string("\xF0\x9D\x84\x9E"), std::string(doc.lit_get_string(doc.lit_get_array_element(a, 1))));
+
+    char bad[] = "[\"abc\\x\"]";
+    CHECK_EQ(LIT_PARSE_INVALID_STRING_ESCAPE, doc.LitParseInsitu(bad));
+    CHECK_EQ(LIT_NULL, doc.lit_get_type(doc.lit_get_root()));
+}
+
+// every way of cutting the text into chunks of n bytes gives what the bounded LitParse gives
+static void CheckPush(const std::string &json, const char *file_name, int line_num) {
+    LitValue expect, actual;
+    ParseResultType res = lit.LitParse(&expect, json.data(), json.size());
+    LitPushParser push;
+    for (size_t n = 1; n <= json.size() + 1; n = n < 8 ? n + 1 : n * 2) {
+        for (size_t i = 0; i < json.size(); i += n) push.Feed(json.data() + i, std::min(n, json.size() - i));
+        CheckEquality(res, push.Finish(&actual), file_name, line_num);
+        CheckEquality(lit.LitStringify(expect), lit.LitStringify(actual), file_name, line_num);
+    }
+}
+
+#define CHECK_PUSH(json) CheckPush(json, __FILE__, __LINE__)
+
+static void TestPushParser() {
+    CHECK_PUSH("null");
+    CHECK_PUSH(" true ");
+    CHECK_PUSH("-1.25e-7");
+    CHECK_PUSH("18446744073709551615");
+    CHECK_PUSH("\"Hello\\\"\\u00e9\\uD834\\uDD1E\\\\\\\"\"");
+    CHECK_PUSH(" [ 1 , [ ] , { } , \"a\" , [ null , false ] ] ");
+    CHECK_PUSH("{\"n\":null,\"o\":{\"1\":1,\"2\":[2.5,\"\\\"\"]},\"s\":\"\\\\\"}");
+
+    // errors, including the ones LitParse only reports when it reaches the end
+    CHECK_PUSH("");
+    CHECK_PUSH("nul");
+    CHECK_PUSH("nulll");
+    CHECK_PUSH("0123");
+    CHECK_PUSH("[1e5e5]");
+    CHECK_PUSH("1.");
+    CHECK_PUSH("-");
+    CHECK_PUSH("1e309");
+    CHECK_PUSH("[1,]");
+    CHECK_PUSH("[1");
+    CHECK_PUSH("[");
+    CHECK_PUSH("{");
+    CHECK_PUSH("{\"a\"");
+    CHECK_PUSH("{\"a\":1,");
+    CHECK_PUSH("{\"a\":1 \"b\"");
+    CHECK_PUSH("{1:1}");
+    CHECK_PUSH("\"abc");
+    CHECK_PUSH("\"abc\\");
+    CHECK_PUSH("\"\\u12\"");
+    CHECK_PUSH("\"\\uD800\\\"");
+    CHECK_PUSH("\"\\x\"");
+    CHECK_PUSH("\"\x01\"");
+    CHECK_PUSH("[\"a\"]]");
+
+    // a '\0' fails like the end of the text, also inside a string whose closing quote follows
+    CHECK_PUSH(std::string("\"a\0b\"", 5));
+    CHECK_PUSH(std::string("{\"a\0\":1}", 9));
+    CHECK_PUSH(std::string("[1,\0]", 5));
+    CHECK_PUSH(std::string("\0", 1));
+    CHECK_PUSH(std::string("1 \0", 3));
+    LitPushParser zero;
+    LitValue z;
+    CHECK_EQ(LIT_PARSE_OK, zero.Feed("[\"a", 3));
+    CHECK_EQ(LIT_PARSE_MISS_QUOTATION_MARK, zero.Feed("\0\"]", 3));
+    CHECK_EQ(LIT_PARSE_MISS_QUOTATION_MARK, zero.Finish(&z));
+
+    // the parser is reusable after an error
+    LitPushParser push;
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, push.Feed("[tr", 3));
+    CHECK_EQ(LIT_PARSE_INVALID_VALUE, push.Feed("ie]", 3));
+    CHECK_EQ(LIT_PARSE_INVALID_VALUE, push.Feed("[]", 2));
+    CHECK_EQ(LIT_PARSE_INVALID_VALUE, push.Finish(&v));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+    CHECK_EQ(LIT_PARSE_OK, push.Feed("[true]", 6));
+    CHECK_EQ(LIT_PARSE_OK, push.Finish(&v));
+    CHECK_EQ(std::string("[true]"), lit.LitStringify(v));
+
+    // nesting is limited like in LitParse, the same for every chunking
+    const size_t depth = LitJson::kDefaultMaxDepth;
+    CHECK_EQ(depth, push.lit_get_max_depth());
+    CHECK_PUSH(std::string(depth, '[') + std::string(depth, ']'));
+    CHECK_PUSH(std::string(depth + 1, '[') + std::string(depth + 1, ']'));
+    CHECK_PUSH("{\"a\":" + std::string(depth, '[') + std::string(depth, ']') + "}");
+    std::string open(1000000, '['), close(1000000, ']');
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, push.Feed(open.data(), open.size()));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, push.Feed(close.data(), close.size()));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, push.Finish(&v));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+    push.lit_set_max_depth(1);
+    CHECK_EQ(LIT_PARSE_OK, push.Feed("[1,", 3));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, push.Feed("[2]]", 4));
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, push.Finish(&v));
+    CHECK_EQ(LIT_PARSE_OK, push.Feed("[1]", 3));
+    CHECK_EQ(LIT_PARSE_OK, push.Finish(&v));
+}
+
+// records every event as a short token, returns false once `limit` events were seen
+struct EventLog : LitBaseHandler {
+    bool Event(const std::string &e) {
+        log += e + " ";
+        return --limit != 0;
+    }
+    bool Null() { return Event("n"); }
+    bool Bool(bool b) { return Event(b ? "t" : "f"); }
+    bool Double(double d) { return Event("d" + std::to_string(d)); }
+    bool Int64(int64_t i) { return Event("i" + std::to_string(i)); }
+    bool Uint64(uint64_t u) { return Event("u" + std::to_string(u)); }
+    bool String(const char *str, size_t len) { return Event("s:" + std::string(str, len)); }
+    bool Key(const char *str, size_t len) { return Event("k:" + std::string(str, len)); }
+    bool StartObject() { return Event("{"); }
+    bool EndObject(size_t n) { return Event("}" + std::to_string(n)); }
+    bool StartArray() { return Event("["); }
+    bool EndArray(size_t n) { return Event("]" + std::to_string(n)); }
+
+    std::string log;
+    int limit = -1;
+};
+
+static void TestReader() {
+    LitReader<EventLog> reader;
+    EventLog h;
+    CHECK_EQ(LIT_PARSE_OK,
+             reader.LitParse(" { \"a\" : [ 1 , -2 , 18446744073709551615 , 0.5 , [ ] ] , \"b\\n\" : { \"c\" : null } , "
+                             "\"d\" : \"x\\u0041y\" , \"e\" : true , \"f\" : false } ",
+                             &h));
+    CHECK_EQ(std::string("{ k:a [ i1 i-2 u18446744073709551615 d0.500000 [ ]0 ]5 k:b\n { k:c n }1 k:d s:xAy k:e t "
+                         "k:f f }5 "),
+             h.log);
+
+    // handler stops the parse
+    h = EventLog();
+    h.limit = 3;
+    CHECK_EQ(LIT_PARSE_TERMINATED, reader.LitParse("[1,[2,3]]", &h));
+    CHECK_EQ(std::string("[ i1 [ "), h.log);
+
+    // the same errors as LitParse
+    static const char *kInvalid[] = {
+        "", "nul", "0123", "[1e5e5]", "1e309", "[1,]", "[1", "{", "{\"a\"", "{\"a\":1,", "{1:1}", "\"abc",
+        "\"\\x\"", "[\"a\"]]", "\"\x01\"", "\"\\uD800\"", "{\"a\":1 \"b\""};
+    for (const char *json : kInvalid) {
+        LitValue v;
+        h = EventLog();
+        CHECK_EQ(lit.LitParse(&v, json), reader.LitParse(json, &h));
+    }
+
+    // nesting is limited like in LitJson, for the tape and LitExtract built on the reader too
+    const size_t depth = LitJson::kDefaultMaxDepth;
+    CHECK_EQ(depth, reader.lit_get_max_depth());
+    std::string deep = std::string(depth, '[') + std::string(depth, ']');
+    h = EventLog();
+    CHECK_EQ(LIT_PARSE_OK, reader.LitParse(deep.c_str(), &h));
+    h = EventLog();
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, reader.LitParse(("{\"a\":" + deep + "}").c_str(), &h));
+    std::string hostile(1000000, '[');
+    h = EventLog();
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, reader.LitParse(hostile.c_str(), &h));
+    reader.lit_set_max_depth(1);
+    h = EventLog();
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, reader.LitParse("[1,[2]]", &h));
+    CHECK_EQ(std::string("[ i1 "), h.log);
+    LitTapeDocument doc;
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, doc.LitParse(hostile.c_str()));
+    LitPointer p;
+    CHECK_EQ(true, p.LitCompile("/0"));
+    std::vector<LitValue> found;
+    CHECK_EQ(LIT_PARSE_DEPTH_EXCEEDED, p.LitExtract(hostile.c_str(), &found));
+}
+
+static void TestLazy() {
+    const char *json =
+        "{\"id\":42,\"big\":18446744073709551615,\"pi\":3.25,\"ok\":true,\"none\":null,\"tags\":[\"a\",[1,[2]],{}],"
+        " \"user\" : { \"name\" : \"J\\u00e9r\\u00f4me\", \"a\\\"b\" : [ ] } , \"id\":7}";
+    LitLazyDocument doc;
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(json));
+    LitLazyValue root = doc.lit_get_root();
+    CHECK_EQ(LIT_OBJECT, doc.lit_get_type(root));
+    CHECK_EQ(static_cast<size_t>(8), doc.lit_get_object_size(root));
+
+    int64_t i = 0;
+    uint64_t u = 0;
+    double n = 0.0;
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_get_int64(doc.lit_find_object_value(root, "id", 2), &i));
+    CHECK_EQ(static_cast<int64_t>(42), i);  // the first of duplicate keys
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_get_uint64(doc.lit_find_object_value(root, "big", 3), &u));
+    CHECK_EQ(UINT64_MAX, u);
+    CHECK_EQ(LIT_PARSE_INVALID_VALUE, doc.lit_get_int64(doc.lit_find_object_value(root, "big", 3), &i));
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_get_number(doc.lit_find_object_value(root, "pi", 2), &n));
+    CHECK_EQ(3.25, n);
+    CHECK_EQ(true, doc.lit_get_boolean(doc.lit_find_object_value(root, "ok", 2)));
+    CHECK_EQ(LIT_NULL, doc.lit_get_type(doc.lit_find_object_value(root, "none", 4)));
+    CHECK_EQ(false, doc.lit_find_object_value(root, "nope", 4).lit_is_valid());
+
+    // siblings are jumped over, nested arrays and objects included
+    LitLazyValue tags = doc.lit_find_object_value(root, "tags", 4);
+    CHECK_EQ(static_cast<size_t>(3), doc.lit_get_array_size(tags));
+    CHECK_EQ(LIT_OBJECT, doc.lit_get_type(doc.lit_get_array_element(tags, 2)));
+    CHECK_EQ(false, doc.lit_get_array_element(tags, 3).lit_is_valid());
+    CHECK_EQ(static_cast<size_t>(2), doc.lit_get_array_size(doc.lit_get_array_element(tags, 1)));
+    CHECK_EQ(false, doc.lit_get_first_member(doc.lit_get_array_element(tags, 2)).lit_is_valid());
+
+    LitLazyValue user = doc.lit_find_object_value(root, "user", 4);
+    std::string s;
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_get_string(doc.lit_find_object_value(user, "name", 4), &s));
+    CHECK_EQ(std::string("J\xC3\xA9r\xC3\xB4me"), s);
+    LitLazyValue escaped = doc.lit_find_object_value(user, "a\"b", 3);
+    CHECK_EQ(static_cast<size_t>(0), doc.lit_get_array_size(escaped));
+    CHECK_EQ(false, doc.lit_get_first_element(escaped).lit_is_valid());
+
+    std::string keys;
+    for (LitLazyValue k = doc.lit_get_first_member(root); k.lit_is_valid(); k = doc.lit_get_next_member(k)) {
+        CHECK_EQ(LIT_PARSE_OK, doc.lit_get_string(k, &s));
+        keys += s + ",";
+    }
+    CHECK_EQ(std::string("id,big,pi,ok,none,tags,user,id,"), keys);
+
+    LitValue v, expect;
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_to_value(user, &v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&expect, json));
+    CHECK_EQ(lit.LitStringify(*lit.lit_find_object_value(expect, "user", 4)), lit.LitStringify(v));
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_to_value(root, &v));
+    CHECK_EQ(lit.LitStringify(expect), lit.LitStringify(v));
+
+    // structure errors are found by LitParse
+    const char *invalid[] = {"", " ", "[1,", "[1 2]", "[1,]", "{\"a\" 1}", "{1:2}", "{\"a\":1,}", "\"abc", "[\"a\\\"]",
+                             "nul", "truex", "1 2", "{\"a\":[}", "+1", "\"a\"b"};
+    for (const char *text : invalid) {
+        LitValue t;
+        ParseResultType res = doc.LitParse(text);
+        CHECK_EQ(true, res != LIT_PARSE_OK && lit.LitParse(&t, text) != LIT_PARSE_OK);
+        CHECK_EQ(false, doc.lit_get_root().lit_is_valid());
+    }
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, doc.LitParse("[1 2]"));
+    CHECK_EQ(LIT_PARSE_MISS_KEY, doc.LitParse("{1:2}"));
+    CHECK_EQ(LIT_PARSE_MISS_COLON, doc.LitParse("{\"a\" 1}"));
+    CHECK_EQ(LIT_PARSE_MISS_QUOTATION_MARK, doc.LitParse("[\"a\\\"]"));
+
+    // broken numbers and strings are found when they are read
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse("[1x, 01, \"\\q\", \"\\u12\", 1e999]"));
+    LitLazyValue arr = doc.lit_get_root();
+    CHECK_EQ(LIT_PARSE_INVALID_VALUE, doc.lit_get_number(doc.lit_get_array_element(arr, 0), &n));
+    CHECK_EQ(LIT_PARSE_INVALID_VALUE, doc.lit_get_number(doc.lit_get_array_element(arr, 1), &n));
+    CHECK_EQ(LIT_PARSE_INVALID_STRING_ESCAPE, doc.lit_get_string(doc.lit_get_array_element(arr, 2), &s));
+    CHECK_EQ(LIT_PARSE_INVALID_UNICODE_HEX, doc.lit_get_string(doc.lit_get_array_element(arr, 3), &s));
+    CHECK_EQ(LIT_PARSE_NUMBER_TOO_BIG, doc.lit_get_number(doc.lit_get_array_element(arr, 4), &n));
+    CHECK_EQ(LIT_PARSE_NUMBER_TOO_BIG, doc.lit_to_value(doc.lit_get_array_element(arr, 4), &v));
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, doc.lit_to_value(arr, &v));
+
+    // bounded texts, a number may run into the end
+    std::string text = "[1,[2]]-12345";
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(text.data() + 7, 3));
+    CHECK_EQ(LIT_PARSE_OK, doc.lit_get_int64(doc.lit_get_root(), &i));
+    CHECK_EQ(static_cast<int64_t>(-12), i);
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(text.data(), 7));
+    CHECK_EQ(static_cast<size_t>(2), doc.lit_get_array_size(doc.lit_get_root()));
+}
+
+static void TestTape() {
+    const char *json =
+        "{\"id\":42,\"big\":18446744073709551615,\"pi\":3.25,\"ok\":true,\"none\":null,\"tags\":[\"a\",[1,[2]],{}],"
+        "\"user\":{\"name\":\"J\\u00e9r\\u00f4me\",\"a\\u0000b\":[]},\"id\":-7}";
+    LitTapeDocument doc;
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(json));
+    LitTapeValue root = doc.lit_get_root();
+    CHECK_EQ(LIT_OBJECT, doc.lit_get_type(root));
+    CHECK_EQ(static_cast<size_t>(8), doc.lit_get_object_size(root));
+
+    CHECK_EQ(static_cast<int64_t>(42), doc.lit_get_int64(doc.lit_find_object_value(root, "id", 2)));
+    CHECK_EQ(LIT_NUMBER_UINT64, doc.lit_get_number_type(doc.lit_find_object_value(root, "big", 3)));
+    CHECK_EQ(UINT64_MAX, doc.lit_get_uint64(doc.lit_find_object_value(root, "big", 3)));
+    CHECK_EQ(3.25, doc.lit_get_number(doc.lit_find_object_value(root, "pi", 2)));
+    CHECK_EQ(true, doc.lit_get_boolean(doc.lit_find_object_value(root, "ok", 2)));
+    CHECK_EQ(LIT_NULL, doc.lit_get_type(doc.lit_find_object_value(root, "none", 4)));
+    CHECK_EQ(false, doc.lit_find_object_value(root, "nope", 4).lit_is_valid());
+
+    LitTapeValue tags = doc.lit_find_object_value(root, "tags", 4);
+    CHECK_EQ(static_cast<size_t>(3), doc.lit_get_array_size(tags));
+    CHECK_EQ(LIT_OBJECT, doc.lit_get_type(doc.lit_get_array_element(tags, 2)));
+    CHECK_EQ(false, doc.lit_get_array_element(tags, 3).lit_is_valid());
+    CHECK_EQ(static_cast<size_t>(2), doc.lit_get_array_size(doc.lit_get_array_element(tags, 1)));
+    CHECK_EQ(false, doc.lit_get_first_member(doc.lit_get_array_element(tags, 2)).lit_is_valid());
+
+    LitTapeValue user = doc.lit_find_object_value(root, "user", 4);
+    LitTapeValue name = doc.lit_find_object_value(user, "name", 4);
+    CHECK_EQ(std::string("J\xC3\xA9r\xC3\xB4me"),
+             std::string(doc.lit_get_string(name), doc.lit_get_string_length(name)));
+    LitTapeValue key = doc.lit_get_next_member(doc.lit_get_first_member(user));
+    CHECK_EQ(static_cast<size_t>(3), doc.lit_get_string_length(key));
+    CHECK_EQ(std::string("a\0b", 3), std::string(doc.lit_get_string(key), 3));
+    CHECK_EQ(false, doc.lit_get_first_element(doc.lit_get_member_value(key)).lit_is_valid());
+    CHECK_EQ(false, doc.lit_get_next_member(key).lit_is_valid());
+
+    // to and from LitValue keep the text and the number types
+    LitValue v, back;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json));
+    doc.lit_to_value(root, &back);
+    CHECK_EQ(lit.LitStringify(v), lit.LitStringify(back));
+    doc.lit_to_value(tags, &back);
+    CHECK_EQ(std::string("[\"a\",[1,[2]],{}]"), lit.LitStringify(back));
+
+    LitTapeDocument copy;
+    copy.LitFromValue(v);
+    CHECK_EQ(doc.lit_get_tape_size(), copy.lit_get_tape_size());
+    CHECK_EQ(doc.lit_get_string_buffer_size(), copy.lit_get_string_buffer_size());
+    copy.lit_to_value(copy.lit_get_root(), &back);
+    CHECK_EQ(lit.LitStringify(v), lit.LitStringify(back));
+
+    // scalars at the root, a failed parse leaves no root
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse("-0"));
+    CHECK_EQ(LIT_NUMBER_DOUBLE, doc.lit_get_number_type(doc.lit_get_root()));
+    CHECK_EQ(LIT_PARSE_OK, doc.LitParse(" \"\" "));
+    CHECK_EQ(static_cast<size_t>(0), doc.lit_get_string_length(doc.lit_get_root()));
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, doc.LitParse("[1,[2}"));
+    CHECK_EQ(false, doc.lit_get_root().lit_is_valid());
+    CHECK_EQ(LIT_PARSE_ROOT_NOT_SINGULAR, doc.LitParse("[] x"));
+    CHECK_EQ(false, doc.lit_get_root().lit_is_valid());
+}
+
+static void TestPointer() {
+    const char *json = "{\"a\":[{\"b\":1},{\"b\":2,\"c\":null},{\"c\":3}],\"a/b\":4,\"m~n\":5,\"\":6,\"*\":7,\"10\":[8],"
+                       "\"a\":\"dup\"}";
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json));
+
+    LitPointer p;
+    CHECK_EQ(true, p.LitCompile(""));
+    CHECK_EQ(true, p.LitFind(v) == &v);
+    CHECK_EQ(true, p.LitCompile("/a/1/b"));
+    CHECK_EQ(2.0, lit.lit_get_number(*p.LitFind(v)));
+    CHECK_EQ(true, p.LitCompile("/a~1b"));
+    CHECK_EQ(4.0, lit.lit_get_number(*p.LitFind(v)));
+    CHECK_EQ(true, p.LitCompile("/m~0n"));
+    CHECK_EQ(5.0, lit.lit_get_number(*p.LitFind(v)));
+    CHECK_EQ(true, p.LitCompile("/"));
+    CHECK_EQ(6.0, lit.lit_get_number(*p.LitFind(v)));
+    CHECK_EQ(true, p.LitCompile("/*"));  // on an object "*" is a key
+    CHECK_EQ(7.0, lit.lit_get_number(*p.LitFind(v)));
+    CHECK_EQ(true, p.LitCompile("/10/0"));  // on an object an index is a key
+    CHECK_EQ(8.0, lit.lit_get_number(*p.LitFind(v)));
+
+    const char *missing[] = {"/x", "/a/3", "/a/-", "/a/01", "/a/0/b/c", "/a/b"};
+    for (const char *m : missing) {
+        CHECK_EQ(true, p.LitCompile(m));
+        CHECK_EQ(true, p.LitFind(v) == nullptr);
+    }
+    const char *invalid[] = {"a", "/~", "/~2", "/a~"};
+    for (const char *m : invalid) {
+        CHECK_EQ(false, p.LitCompile(m));
+        CHECK_EQ(true, p.LitFind(v) == nullptr);
+    }
+
+    // wildcards over arrays, matches in document order
+    std::vector<const LitValue *> all;
+    CHECK_EQ(true, p.LitCompile("/a/*/b"));
+    p.LitFindAll(v, &all);
+    CHECK_EQ(static_cast<size_t>(2), all.size());
+    CHECK_EQ(1.0, lit.lit_get_number(*all[0]));
+    CHECK_EQ(2.0, lit.lit_get_number(*all[1]));
+    CHECK_EQ(true, p.LitFind(v) == all[0]);
+    LitValue *w = p.LitFind(v);
+    lit.lit_set_number(w, 9.0);
+    CHECK_EQ(9.0, lit.lit_get_number(*all[0]));
+
+    // extraction while parsing builds nothing but the matches
+    std::vector<LitValue> res;
+    CHECK_EQ(true, p.LitCompile("/a/*/c"));
+    CHECK_EQ(LIT_PARSE_OK, p.LitExtract(json, &res));
+    CHECK_EQ(static_cast<size_t>(2), res.size());
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(res[0]));
+    CHECK_EQ(3.0, lit.lit_get_number(res[1]));
+    res.clear();
+    CHECK_EQ(true, p.LitCompile("/a"));  // the first of duplicate keys
+    CHECK_EQ(LIT_PARSE_OK, p.LitExtract(json, &res));
+    CHECK_EQ(static_cast<size_t>(1), res.size());
+    CHECK_EQ(std::string("[{\"b\":1},{\"b\":2,\"c\":null},{\"c\":3}]"), lit.LitStringify(res[0]));
+
+    // a pointer without wildcards stops at its match, errors before it are reported and leave res unchanged
+    CHECK_EQ(true, p.LitCompile("/a/0"));
+    CHECK_EQ(LIT_PARSE_OK, p.LitExtract("{\"a\":[true,", &res));
+    CHECK_EQ(static_cast<size_t>(2), res.size());
+    CHECK_EQ(LIT_PARSE_MISS_COLON, p.LitExtract("{\"x\" 1, \"a\":[true]}", &res));
+    CHECK_EQ(static_cast<size_t>(2), res.size());
+    CHECK_EQ(true, p.LitCompile("/a/*"));
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, p.LitExtract("{\"a\":[true,false}", &res));
+    CHECK_EQ(static_cast<size_t>(2), res.size());
+}
+
+static void TestNdjson() {
+    // enough lines for many ranges, some blank, some with "\r\n", some invalid
+    std::string text;
+    std::vector<std::string> lines;
+    for (int i = 0; i < 20000; ++i) {
+        std::string line = "{\"id\":" + std::to_string(i) + ",\"tags\":[\"" + std::string(i % 50, 'x') + "\"]}";
+        if (i % 97 == 0) line = "[1,";
+        if (i % 89 == 0) line += "\r";
+        if (i % 83 == 0) text += "\n  \n";
+        lines.push_back(line);
+        text += line + "\n";
+    }
+    text.pop_back();
+
+    LitNdjsonParser parser(4);
+    std::vector<LitNdjsonRecord> records;
+    CHECK_EQ(LIT_PARSE_OK, parser.LitParse(text.data(), text.size(), &records));
+    CHECK_EQ(lines.size(), records.size());
+    bool same = records.size() == lines.size();
+    for (size_t i = 0; same && i < lines.size(); ++i) {
+        LitValue v;
+        same = lit.LitParse(&v, lines[i].c_str()) == records[i].result &&
+               lit.LitStringify(v) == lit.LitStringify(records[i].value) &&
+               text.compare(records[i].offset, records[i].length, lines[i]) == 0;
+    }
+    CHECK_EQ(true, same);
+    CHECK_EQ(LIT_PARSE_EXPECT_VALUE, records[97].result);
+
+    // the callback sees the records in order and can stop the batch
+    size_t seen = 0;
+    bool ordered = true;
+    CHECK_EQ(LIT_PARSE_TERMINATED, parser.LitParse(text.data(), text.size(), [&](LitNdjsonRecord *r) {
+        ordered = ordered && r->offset == records[seen].offset;
+        return ++seen < 5000;
+    }));
+    CHECK_EQ(static_cast<size_t>(5000), seen);
+    CHECK_EQ(true, ordered);
+
+    CHECK_EQ(LIT_PARSE_OK, parser.LitParse("", 0, &records));
+    CHECK_EQ(static_cast<size_t>(0), records.size());
+    CHECK_EQ(LIT_PARSE_OK, parser.LitParse("1\n\n2", 4, &records));
+    CHECK_EQ(static_cast<size_t>(2), records.size());
+    CHECK_EQ(static_cast<size_t>(3), records[1].offset);
+    CHECK_EQ(LIT_PARSE_FILE_ERROR, parser.LitParseFile("lit_no_such_file.ndjson", &records));
+}
+
+static void TestConcurrent() {
+    // one shared LitJson parses on several threads at once, each thread checks its own results
+    std::string big = "[";
+    for (int i = 0; i < 20000; ++i) big += (i > 0 ? ", " : "") + std::to_string(i);
+    big += "]";
+    const char *texts[] = {"{\"a\":[1,2.5,\"x\\n\"],\"b\":null}", "[1,", "  \"tail", big.c_str()};
+    std::vector<std::string> expect;
+    std::vector<ParseResultType> expect_res;
+    for (const char *json : texts) {
+        LitValue v;
+        expect_res.push_back(lit.LitParse(&v, json, strlen(json)));
+        expect.push_back(lit.LitStringify(v));
+    }
+
+    // and looks up keys of one shared large object whose index does not exist yet
+    std::string json = "{";
+    for (int i = 0; i < 1000; ++i) json += (i > 0 ? ",\"k" : "\"k") + std::to_string(i) + "\":" + std::to_string(i);
+    json += "}";
+    LitValue obj;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&obj, json.c_str()));
+
+    const int kThreads = 4;
+    std::vector<char> ok(kThreads, 1);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 20; ++round) {
+                for (size_t i = 0; i < expect.size(); ++i) {
+                    LitValue v;
+                    if (lit.LitParse(&v, texts[i], strlen(texts[i])) != expect_res[i] ||
+                        lit.LitStringify(v) != expect[i]) {
+                        ok[t] = 0;
+                    }
+                }
+                for (int i = t; i < 1000; i += 7) {
+                    std::string key = "k" + std::to_string(i);
+                    if (lit.lit_find_object_index(obj, key.c_str(), key.size()) != static_cast<size_t>(i)) ok[t] = 0;
+                }
+            }
+        });
+    }
+    for (std::thread &t : threads) t.join();
+    for (int t = 0; t < kThreads; ++t) CHECK_EQ(1, static_cast<int>(ok[t]));
+}
+
+static void TestParseIndexed() {
+    // inputs past 64 KiB that are mostly whitespace go through the structural index, padding keeps the meaning of
+    // the text unchanged
+    std::string pad(64 * 1024, ' ');
+    CHECK_ERROR(LIT_PARSE_EXPECT_VALUE, pad.c_str());
+    CHECK_ERROR(LIT_PARSE_ROOT_NOT_SINGULAR, (pad + "nulll").c_str());
+    CHECK_ERROR(LIT_PARSE_ROOT_NOT_SINGULAR, (pad + "null  x").c_str());
+    CHECK_ERROR(LIT_PARSE_INVALID_VALUE, ("[ 1 ,  ]" + pad).c_str());
+    CHECK_ERROR(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, ("[ \"a\"  \"b\" ]" + pad).c_str());
+    CHECK_ERROR(LIT_PARSE_MISS_COLON, ("{ \"a\\\"\"   , 1 }" + pad).c_str());
+    CHECK_ERROR(LIT_PARSE_MISS_QUOTATION_MARK, (pad + "[\"a\\\"]   ").c_str());
+
+    // escaped quotation marks and backslashes at block boundaries must not flip the string state
+    std::string json = pad + "[";
+    for (int i = 0; i < 200; ++i) {
+        json += i > 0 ? " ,\n  " : "\n  ";
+        json += "{ \"k\\\\\" : \"" + std::string(i % 67, 'x') + "\\\" ] , {\" ,   \"n\" : [ " + std::to_string(i) + " ] }";
+    }
+    json += "\n]";
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json.c_str()));
+    CHECK_EQ(static_cast<size_t>(200), lit.lit_get_array_size(v));
+    LitValue& last = lit.lit_get_array_element(v, 199);
+    CHECK_EQ(std::string("k\\"), lit.lit_get_object_key(last, 0));
+    CHECK_EQ(std::string(199 % 67, 'x') + "\" ] , {", lit.lit_get_string(lit.lit_get_object_value(last, 0)));
+    CHECK_EQ(199.0, lit.lit_get_number(lit.lit_get_array_element(lit.lit_get_object_value(last, 1), 0)));
+
+    // compact text as large is parsed without the index
+    std::string compact = "[";
+    for (int i = 0; i < 20000; ++i) compact += (i > 0 ? ",\"" : "\"") + std::to_string(i) + "\"";
+    compact += "]";
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, compact.c_str()));
+    CHECK_EQ(static_cast<size_t>(20000), lit.lit_get_array_size(v));
+    CHECK_EQ(std::string("19999"), lit.lit_get_string(lit.lit_get_array_element(v, 19999)));
+}
+
+// parse an exact-size copy without terminator, so that a sanitizer build catches any read past the end (the
+// vector string scan is exempt, its aligned over-read is documented at LitJson::LitParse)
+static void CheckBounded(const std::string &json, const char *file_name, int line_num) {
+    LitValue expect, actual;
+    ParseResultType res = lit.LitParse(&expect, json.c_str());
+    std::vector<char> text(json.begin(), json.end());
+    CheckEquality(res, lit.LitParse(&actual, text.data(), text.size()), file_name, line_num);
+    CheckEquality(lit.LitStringify(expect), lit.LitStringify(actual), file_name, line_num);
+}
+
+#define CHECK_BOUNDED(json) CheckBounded(json, __FILE__, __LINE__)
+
+static void TestParseBounded() {
+    CHECK_BOUNDED("");
+    CHECK_BOUNDED("  ");
+    CHECK_BOUNDED("true");
+    CHECK_BOUNDED("tru");
+    CHECK_BOUNDED("fals");
+    CHECK_BOUNDED("nul");
+    CHECK_BOUNDED("123");
+    CHECK_BOUNDED("-1.5e");
+    CHECK_BOUNDED(" 1e-10 \n");
+    CHECK_BOUNDED("\"abc\"");
+    CHECK_BOUNDED("\"abc");
+    CHECK_BOUNDED("\"abc\\\"");
+    CHECK_BOUNDED("\"\\u00");
+    CHECK_BOUNDED("[\"a\",\"b\\\\\", 1]");
+    CHECK_BOUNDED("[\"a\",\"b\\\\\", \"c]");
+    CHECK_BOUNDED("[1,2");
+    CHECK_BOUNDED("[1,");
+    CHECK_BOUNDED("[");
+    CHECK_BOUNDED("{\"a\"");
+    CHECK_BOUNDED("{\"a\":");
+    CHECK_BOUNDED("{\"a\":1");
+    CHECK_BOUNDED("{\"a\":1} x");
+    CHECK_BOUNDED(std::string(64 * 1024, ' ') + "[\"a\", 1.5]  ");
+    CHECK_BOUNDED(std::string(64 * 1024, ' ') + "[\"a\", 15");
+    CHECK_BOUNDED(std::string(64 * 1024, ' ') + "[\"a\", \"b");
+
+    // a slice of a larger text
+    const char *json = "[1,2]xyz";
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json, 5));
+    CHECK_EQ(std::string("[1,2]"), lit.LitStringify(v));
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json + 1, 1));
+    CHECK_EQ(1.0, lit.lit_get_number(v));
+    CHECK_EQ(LIT_PARSE_ROOT_NOT_SINGULAR, lit.LitParse(&v, json, 6));
+
+    // a '\0' fails inside a value like the end of a C string, after the root it is not whitespace
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "1\0x"));
+    CHECK_EQ(LIT_PARSE_ROOT_NOT_SINGULAR, lit.LitParse(&v, "1\0x", 3));
+    CHECK_EQ(LIT_PARSE_ROOT_NOT_SINGULAR, lit.LitParse(&v, "1\0", 2));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+    CHECK_EQ(lit.LitParse(&v, "[1,\0]"), lit.LitParse(&v, "[1,\0]", 5));
+    CHECK_EQ(lit.LitParse(&v, "\"a\0b\""), lit.LitParse(&v, "\"a\0b\"", 5));
+}
+
+// with a cache the tree and every error are the same as without, however the cache was trained
+static void CheckShapeCache(LitShapeCache *cache, const std::string &json, const char *file_name, int line_num) {
+    LitValue expect, v;
+    ParseResultType res = lit.LitParse(&expect, json.data(), json.size());
+    CheckEquality(res, lit.LitParse(&v, json.data(), json.size(), cache), file_name, line_num);
+    CheckEquality(lit.LitStringify(expect), lit.LitStringify(v), file_name, line_num);
+}
+
+#define CHECK_SHAPE_CACHE(cache, json) CheckShapeCache(cache, json, __FILE__, __LINE__)
+
+static void TestParseShapeCache() {
+    LitShapeCache cache;
+    std::string records = "[";
+    for (int i = 0; i < 100; ++i) {
+        if (i > 0) records += ",";
+        records += "{\"id\":" + std::to_string(i) + ",\"name\":\"n" + std::to_string(i) +
+                   "\",\"user\":{\"name\":\"u\",\"a long key past the short string buffer\":[{\"x\":1},{\"x\":2}]}}";
+    }
+    records += "]";
+    CHECK_SHAPE_CACHE(&cache, records);
+    CHECK_SHAPE_CACHE(&cache, records);
+    CHECK_EQ(static_cast<size_t>(5), cache.lit_get_key_count());
+    CHECK_EQ(static_cast<size_t>(7), cache.lit_get_shape_count());
+
+    // keys that only look alike in the text: prefixes, longer keys, escapes, the empty key
+    CHECK_SHAPE_CACHE(&cache, "{\"i\":1,\"name\":2}");
+    CHECK_SHAPE_CACHE(&cache, "{\"idx\":1,\"name\":2}");
+    CHECK_SHAPE_CACHE(&cache, "{\"\\u0069d\":1,\"nam\\u0065\":2}");
+    CHECK_SHAPE_CACHE(&cache, "{\"id\" : 1 , \"name\":2,\"id\":3}");
+    CHECK_SHAPE_CACHE(&cache, "{\"a\\\"b\":1}");
+    CHECK_SHAPE_CACHE(&cache, "{\"a\\\"b\":1}");
+    CHECK_SHAPE_CACHE(&cache, "{\"a\\\"bc\":1}");
+    CHECK_SHAPE_CACHE(&cache, "{\"\":1}");
+    CHECK_SHAPE_CACHE(&cache, "{\"\":1}");
+    CHECK_SHAPE_CACHE(&cache, "{\"id\":1,\"name\":{},\"user\":[]}");
+    CHECK_SHAPE_CACHE(&cache, "{\"user\":{\"name\":\"u\"},\"id\":1}");
+
+    // errors, also where the text ends inside a known key
+    static const char *kErrors[] = {"{\"id\"", "{\"id", "{\"i", "{\"id\":1,\"name\"", "{\"id\":1,\"nam",
+                                    "{\"id\":1,\"name\":", "{\"id\" 1}", "{\"id\":1 \"name\":2}", "{\"id\":1,}",
+                                    "{\"id\":1,\"name\":2,\"user\":{\"name\":\"\\x\"}}"};
+    for (const char *json : kErrors) CHECK_SHAPE_CACHE(&cache, json);
+    CHECK_SHAPE_CACHE(&cache, records);
+
+    // every prefix of the records parses like without a cache
+    std::string record = records.substr(1, records.find(",{") - 1);
+    for (size_t i = 0; i <= record.size(); ++i) CHECK_SHAPE_CACHE(&cache, record.substr(0, i));
+
+    // a full cache keeps parsing, it just stops learning
+    std::string wide = "{";
+    for (uint32_t i = 0; i < LitShapeCache::kMaxKeys + 10; ++i) {
+        if (i > 0) wide += ",";
+        wide += "\"k" + std::to_string(i) + "\":" + std::to_string(i);
+    }
+    wide += "}";
+    CHECK_SHAPE_CACHE(&cache, wide);
+    CHECK_EQ(static_cast<size_t>(LitShapeCache::kMaxKeys), cache.lit_get_key_count());
+    CHECK_SHAPE_CACHE(&cache, records);
+    CHECK_SHAPE_CACHE(&cache, "{\"k1\":1,\"k2\":2,\"new\":3}");
+
+    cache.LitClear();
+    CHECK_EQ(static_cast<size_t>(0), cache.lit_get_key_count());
+    CHECK_EQ(static_cast<size_t>(1), cache.lit_get_shape_count());
+    CHECK_SHAPE_CACHE(&cache, records);
+}
+
+static void TestParseFile() {
+    const char *path = "lit_parse_file_test.json";
+    FILE *f = fopen(path, "wb");
+    fputs("{\"a\": [1, \"x\"]}\n", f);
+    fclose(f);
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParseFile(&v, path));
+    CHECK_EQ(std::string("{\"a\":[1,\"x\"]}"), lit.LitStringify(v));
+
+    f = fopen(path, "wb");
+    fclose(f);
+    CHECK_EQ(LIT_PARSE_EXPECT_VALUE, lit.LitParseFile(&v, path));
+    remove(path);
+    CHECK_EQ(LIT_PARSE_FILE_ERROR, lit.LitParseFile(&v, path));
+    CHECK_EQ(LIT_NULL, lit.lit_get_type(v));
+}
+
 static void TestParse() {
     // test type
     TestParseNull();
     TestParseTrue();
     TestParseFalse();
     TestParseNumber();
+    TestParseInteger();
     TestParseString();
+    TestParseLongString();
     TestParseArray();
     TestParseObject();
+    TestParseIndexed();
+    TestParseBounded();
+    TestParseFile();
+    TestParseShapeCache();
 
     // test error
     TestParseExpectValue();
@@ -376,12 +1338,25 @@ static void TestParse() {
     TestParseMissKey();
     TestParseMissColon();
     TestParseMissCommaOrCurlyBracket();
+    TestParseDepthExceeded();
 
     // test access/memory management
     TestAccessNull();
     TestAccessBoolean();
     TestAccessNumber();
     TestAccessString();
+    TestAccessObjectFind();
+    TestAccessMove();
+
+    TestDocument();
+    TestDocumentInsitu();
+    TestPushParser();
+    TestReader();
+    TestLazy();
+    TestTape();
+    TestPointer();
+    TestNdjson();
+    TestConcurrent();
 }
 
 #define CHECK_ROUNDTRIP(json) CheckRoundTrip(json, __FILE__, __LINE__);
@@ -393,6 +1368,7 @@ static void CheckRoundTrip(const char *json, const char *file_name, int line_num
     CheckEquality(LIT_PARSE_OK, lit.LitParse(&v, json), file_name, line_num);
     std::string res_json = lit.LitStringify(v);
     CheckEquality(std::string(json), res_json, file_name, line_num);
+    CheckEquality(true, lit.LitStringifyLength(v) >= res_json.size(), file_name, line_num);
 }
 
 static void TestStringifyNumber() {
@@ -403,19 +1379,49 @@ static void TestStringifyNumber() {
     CHECK_ROUNDTRIP("1.5");
     CHECK_ROUNDTRIP("-1.5");
     CHECK_ROUNDTRIP("3.25");
-    CHECK_ROUNDTRIP("1e+020");
-    CHECK_ROUNDTRIP("1.234e+020");
-    CHECK_ROUNDTRIP("1.234e-020");
+    CHECK_ROUNDTRIP("1e+20");
+    CHECK_ROUNDTRIP("1.234e+20");
+    CHECK_ROUNDTRIP("1.234e-20");
 
     CHECK_ROUNDTRIP("1.0000000000000002");      /* the smallest number > 1 */
-    CHECK_ROUNDTRIP("4.9406564584124654e-324"); /* minimum denormal */
-    CHECK_ROUNDTRIP("-4.9406564584124654e-324");
-    CHECK_ROUNDTRIP("2.2250738585072009e-308"); /* Max subnormal double */
-    CHECK_ROUNDTRIP("-2.2250738585072009e-308");
+    CHECK_ROUNDTRIP("5e-324");                  /* minimum denormal */
+    CHECK_ROUNDTRIP("-5e-324");
+    CHECK_ROUNDTRIP("2.225073858507201e-308");  /* Max subnormal double */
+    CHECK_ROUNDTRIP("-2.225073858507201e-308");
     CHECK_ROUNDTRIP("2.2250738585072014e-308"); /* Min normal positive double */
     CHECK_ROUNDTRIP("-2.2250738585072014e-308");
     CHECK_ROUNDTRIP("1.7976931348623157e+308"); /* Max double */
     CHECK_ROUNDTRIP("-1.7976931348623157e+308");
+
+    // shortest digits that read back as the same double, %.17g would print 0.10000000000000001
+    CHECK_ROUNDTRIP("0.1");
+    CHECK_ROUNDTRIP("0.3");
+    CHECK_ROUNDTRIP("0.30000000000000004");
+    CHECK_ROUNDTRIP("0.0001");
+    CHECK_ROUNDTRIP("1e-05");
+    CHECK_ROUNDTRIP("123456.789");
+    CHECK_ROUNDTRIP("9007199254740991");
+    CHECK_ROUNDTRIP("10000000000000000");
+    CHECK_ROUNDTRIP("1.2345678901234568e+17");
+    CHECK_ROUNDTRIP("1e+100");
+
+    // integers are printed exactly
+    CHECK_ROUNDTRIP("9007199254740993");
+    CHECK_ROUNDTRIP("-9223372036854775808");
+    CHECK_ROUNDTRIP("9223372036854775807");
+    CHECK_ROUNDTRIP("18446744073709551615");
+
+    // no JSON number for NaN and infinity, they are written as null
+    LitValue v;
+    v = std::numeric_limits<double>::quiet_NaN();
+    CHECK_EQ(std::string("null"), lit.LitStringify(v));
+    CHECK_EQ(static_cast<size_t>(4), lit.LitStringifyLength(v));
+    LitValue::Array a(2);
+    a[0] = std::numeric_limits<double>::infinity();
+    a[1] = -std::numeric_limits<double>::infinity();
+    v = std::move(a);
+    CHECK_EQ(std::string("[null,null]"), lit.LitStringify(v));
+    CHECK_EQ(static_cast<size_t>(11), lit.LitStringifyLength(v));
 }
 
 static void TestStringifyString() {
@@ -437,6 +1443,96 @@ static void TestStringifyObject() {
         "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
 }
 
+static void TestStringifyLength() {
+    // exact without fractional doubles
+    const char *exact[] = {"null", "false", "true", "0", "-0", "9", "10", "-9223372036854775808",
+                           "18446744073709551615", "-4503599627370496", "\"\"", "\"\\\" \\\\ \\n\"",
+                           "\"\\u0001\\u001F\\t\"", "[]", "{}", "[1,[2,[]],{\"a\":{}}]",
+                           "{\"k\\u0000\":\"v\",\"x\":[null]}"};
+    for (const char *json : exact) {
+        LitValue v;
+        CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json));
+        CHECK_EQ(strlen(json), lit.LitStringifyLength(v));
+    }
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, "[0.1,-2.5e-300,1.7976931348623157e+308]"));
+    CHECK_EQ(static_cast<size_t>(2 + 2 + 3 * 25), lit.LitStringifyLength(v));
+    CHECK_EQ(std::string("[0.1,-2.5e-300,1.7976931348623157e+308]"), lit.LitStringify(v));
+}
+
+static std::string ReadBack(FILE *f) {
+    std::string res;
+    char buff[256];
+    rewind(f);
+    for (size_t n; (n = fread(buff, 1, sizeof(buff), f)) > 0;) res.append(buff, n);
+    return res;
+}
+
+static void TestStringifySink() {
+    const char *json =
+        "{\"n\":null,\"s\":\"a\\u0001\\\"\\\\\\n\\u00e9\",\"a\":[true,false,1.5,-7,18446744073709551615],"
+        "\"o\":{\"k\":[[],{}]}}";
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json));
+    std::string expect = lit.LitStringify(v);
+
+    // every buffer size from a single byte up makes the text cross a buffer boundary at each position
+    for (size_t capacity = 1; capacity <= expect.size() + 1; ++capacity) {
+        std::string res;
+        size_t calls = 0;
+        LitCallbackSink sink(
+            [&](const char *data, size_t len) {
+                ++calls;
+                res.append(data, len);
+                return true;
+            },
+            capacity);
+        CHECK_EQ(true, lit.LitStringify(v, &sink));
+        CHECK_EQ(expect, res);
+        CHECK_EQ((expect.size() + capacity - 1) / capacity, calls);
+    }
+
+    // a full caller buffer fails the sink and keeps what fit
+    std::vector<char> buff(expect.size());
+    LitBufferSink fits(buff.data(), buff.size());
+    CHECK_EQ(true, lit.LitStringify(v, &fits));
+    CHECK_EQ(expect, std::string(buff.data(), fits.lit_get_size()));
+    LitBufferSink small(buff.data(), 10);
+    CHECK_EQ(false, lit.LitStringify(v, &small));
+    CHECK_EQ(false, small.lit_is_ok());
+    CHECK_EQ(expect.substr(0, 10), std::string(buff.data(), small.lit_get_size()));
+
+    // a callback that returns false stops the output
+    size_t calls = 0;
+    LitCallbackSink stop(
+        [&calls](const char *, size_t) {
+            ++calls;
+            return false;
+        },
+        4);
+    CHECK_EQ(false, lit.LitStringify(v, &stop));
+    CHECK_EQ(static_cast<size_t>(1), calls);
+
+    FILE *f = tmpfile();
+    if (f != nullptr) {
+        {
+            LitFileSink sink(f, 16);
+            CHECK_EQ(true, lit.LitStringify(v, &sink));
+            CHECK_EQ(true, lit.LitStringify(v, &sink));
+        }
+        CHECK_EQ(expect + expect, ReadBack(f));
+        fclose(f);
+    }
+    f = tmpfile();
+    if (f != nullptr) {
+        fflush(f);
+        LitFdSink sink(fileno(f), 16);
+        CHECK_EQ(true, lit.LitStringify(v, &sink));
+        CHECK_EQ(expect, ReadBack(f));
+        fclose(f);
+    }
+}
+
 static void TestStringify() {
     CHECK_ROUNDTRIP("null");
     CHECK_ROUNDTRIP("false");
@@ -445,11 +1541,440 @@ static void TestStringify() {
     TestStringifyString();
     TestStringifyArray();
     TestStringifyObject();
+    TestStringifyLength();
+    TestStringifySink();
+}
+
+static std::string FromHex(const char *hex) {
+    std::string res;
+    for (; hex[0] != '\0' && hex[1] != '\0'; hex += 2) {
+        res.push_back(static_cast<char>(std::stoi(std::string(hex, 2), nullptr, 16)));
+    }
+    return res;
+}
+
+static std::string ToHex(const std::string &bytes) {
+    std::string res;
+    char buff[3];
+    for (unsigned char ch : bytes) {
+        sprintf(buff, "%02x", ch);
+        res += buff;
+    }
+    return res;
+}
+
+#define CHECK_MSGPACK(hex, json) CheckBinary(false, hex, json, __FILE__, __LINE__)
+#define CHECK_CBOR(hex, json) CheckBinary(true, hex, json, __FILE__, __LINE__)
+#define CHECK_MSGPACK_ERROR(error, hex) CheckBinaryError(false, error, hex, __FILE__, __LINE__)
+#define CHECK_CBOR_ERROR(error, hex) CheckBinaryError(true, error, hex, __FILE__, __LINE__)
+
+// json encodes to hex and hex decodes to json
+static void CheckBinary(bool cbor, const char *hex, const char *json, const char *file_name, int line_num) {
+    LitValue v;
+    CheckEquality(LIT_PARSE_OK, lit.LitParse(&v, json), file_name, line_num);
+    CheckEquality(std::string(hex), ToHex(cbor ? lit.LitEncodeCbor(v) : lit.LitEncodeMsgPack(v)), file_name,
+                  line_num);
+    std::string bytes = FromHex(hex);
+    LitValue res;
+    ParseResultType r = cbor ? lit.LitParseCbor(&res, bytes.data(), bytes.size())
+                             : lit.LitParseMsgPack(&res, bytes.data(), bytes.size());
+    CheckEquality(LIT_PARSE_OK, r, file_name, line_num);
+    CheckEquality(std::string(json), lit.LitStringify(res), file_name, line_num);
+}
+
+static void CheckBinaryError(bool cbor, ParseResultType error, const char *hex, const char *file_name,
+                             int line_num) {
+    std::string bytes = FromHex(hex);
+    LitValue v;
+    lit.lit_set_boolean(&v, false);
+    ParseResultType r = cbor ? lit.LitParseCbor(&v, bytes.data(), bytes.size())
+                             : lit.LitParseMsgPack(&v, bytes.data(), bytes.size());
+    CheckEquality(error, r, file_name, line_num);
+    CheckEquality(LIT_NULL, lit.lit_get_type(v), file_name, line_num);
+}
+
+// encode, decode and compare through the text, then every cut short copy must fail as truncated
+static void CheckBinaryRoundTrip(bool cbor, const char *json) {
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json));
+    std::string bytes = cbor ? lit.LitEncodeCbor(v) : lit.LitEncodeMsgPack(v);
+    LitValue res;
+    CHECK_EQ(LIT_PARSE_OK, cbor ? lit.LitParseCbor(&res, bytes.data(), bytes.size())
+                                : lit.LitParseMsgPack(&res, bytes.data(), bytes.size()));
+    CHECK_EQ(lit.LitStringify(v), lit.LitStringify(res));
+
+    size_t truncated = 0;
+    for (size_t len = 0; len < bytes.size(); ++len) {
+        ParseResultType r =
+            cbor ? lit.LitParseCbor(&res, bytes.data(), len) : lit.LitParseMsgPack(&res, bytes.data(), len);
+        truncated += r == LIT_PARSE_EXPECT_VALUE;
+    }
+    CHECK_EQ(bytes.size(), truncated);
+
+    std::vector<char> buff(bytes.size());
+    LitBufferSink sink(buff.data(), buff.size());
+    CHECK_EQ(true, cbor ? lit.LitEncodeCbor(v, &sink) : lit.LitEncodeMsgPack(v, &sink));
+    CHECK_EQ(bytes, std::string(buff.data(), sink.lit_get_size()));
+}
+
+static void TestMsgPack() {
+    CHECK_MSGPACK("c0", "null");
+    CHECK_MSGPACK("c2", "false");
+    CHECK_MSGPACK("c3", "true");
+
+    CHECK_MSGPACK("00", "0");
+    CHECK_MSGPACK("7f", "127");
+    CHECK_MSGPACK("cc80", "128");
+    CHECK_MSGPACK("cd0100", "256");
+    CHECK_MSGPACK("ce00010000", "65536");
+    CHECK_MSGPACK("cf0000000100000000", "4294967296");
+    CHECK_MSGPACK("cfffffffffffffffff", "18446744073709551615");
+    CHECK_MSGPACK("ff", "-1");
+    CHECK_MSGPACK("e0", "-32");
+    CHECK_MSGPACK("d0df", "-33");
+    CHECK_MSGPACK("d080", "-128");
+    CHECK_MSGPACK("d1ff7f", "-129");
+    CHECK_MSGPACK("d2ffff7fff", "-32769");
+    CHECK_MSGPACK("d38000000000000000", "-9223372036854775808");
+    CHECK_MSGPACK("ca3fc00000", "1.5");
+    CHECK_MSGPACK("ca80000000", "-0");
+    CHECK_MSGPACK("cb3fb999999999999a", "0.1");
+
+    CHECK_MSGPACK("a0", "\"\"");
+    CHECK_MSGPACK("a3610062", "\"a\\u0000b\"");
+    CHECK_MSGPACK("d920" "6161616161616161616161616161616161616161616161616161616161616161",
+                  "\"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\"");
+    CHECK_MSGPACK("90", "[]");
+    CHECK_MSGPACK("920190", "[1,[]]");
+    CHECK_MSGPACK("80", "{}");
+    CHECK_MSGPACK("82a16101a162c0", "{\"a\":1,\"b\":null}");
+
+    // the wider forms decode too, integers keep LitParse's number types
+    LitValue v;
+    std::string bytes = FromHex("dc0002cd0001ce80000000");
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParseMsgPack(&v, bytes.data(), bytes.size()));
+    CHECK_EQ(std::string("[1,2147483648]"), lit.LitStringify(v));
+    CHECK_EQ(LIT_NUMBER_INT64, lit.lit_get_number_type(lit.lit_get_array_element(v, 1)));
+    bytes = FromHex("df00000001da0001" "6bd1fffe");
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParseMsgPack(&v, bytes.data(), bytes.size()));
+    CHECK_EQ(std::string("{\"k\":-2}"), lit.LitStringify(v));
+
+    std::string big;
+    for (int i = 0; i < 300; ++i) big += i == 0 ? "[0" : ",{\"k\":\"" + std::string(i, 'x') + "\"}";
+    big += "]";
+    CheckBinaryRoundTrip(false, big.c_str());
+    CheckBinaryRoundTrip(false, "{\"n\":null,\"b\":[true,false],\"x\":[1e+300,-2.5,70000,-70000,\"\\n\"]}");
+
+    CHECK_MSGPACK_ERROR(LIT_PARSE_EXPECT_VALUE, "");
+    CHECK_MSGPACK_ERROR(LIT_PARSE_EXPECT_VALUE, "dfffffffff");  // a huge count with nothing after it
+    CHECK_MSGPACK_ERROR(LIT_PARSE_ROOT_NOT_SINGULAR, "c0c0");
+    CHECK_MSGPACK_ERROR(LIT_PARSE_INVALID_VALUE, "c1");
+    CHECK_MSGPACK_ERROR(LIT_PARSE_INVALID_VALUE, "c40100");  // bin 8
+    CHECK_MSGPACK_ERROR(LIT_PARSE_INVALID_VALUE, "d40100");  // fixext 1
+    CHECK_MSGPACK_ERROR(LIT_PARSE_MISS_KEY, "810101");
+    CHECK_MSGPACK_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "cb7ff8000000000000");
+    CHECK_MSGPACK_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "ca7f800000");
+}
+
+static void TestCbor() {
+    // RFC 8949 appendix A
+    CHECK_CBOR("00", "0");
+    CHECK_CBOR("17", "23");
+    CHECK_CBOR("1818", "24");
+    CHECK_CBOR("1864", "100");
+    CHECK_CBOR("1903e8", "1000");
+    CHECK_CBOR("1a000f4240", "1000000");
+    CHECK_CBOR("1b000000e8d4a51000", "1000000000000");
+    CHECK_CBOR("1bffffffffffffffff", "18446744073709551615");
+    CHECK_CBOR("20", "-1");
+    CHECK_CBOR("29", "-10");
+    CHECK_CBOR("3863", "-100");
+    CHECK_CBOR("3903e7", "-1000");
+    CHECK_CBOR("3b7fffffffffffffff", "-9223372036854775808");
+    CHECK_CBOR("fa3fc00000", "1.5");
+    CHECK_CBOR("fb3ff199999999999a", "1.1");
+    CHECK_CBOR("fbc010666666666666", "-4.1");
+    CHECK_CBOR("f4", "false");
+    CHECK_CBOR("f5", "true");
+    CHECK_CBOR("f6", "null");
+    CHECK_CBOR("60", "\"\"");
+    CHECK_CBOR("6449455446", "\"IETF\"");
+    CHECK_CBOR("80", "[]");
+    CHECK_CBOR("8301820203820405", "[1,[2,3],[4,5]]");
+    CHECK_CBOR("a0", "{}");
+    CHECK_CBOR("a26161016162820203", "{\"a\":1,\"b\":[2,3]}");
+
+    LitValue v;
+    struct {
+        const char *hex;
+        const char *json;
+    } decode[] = {
+        {"3bffffffffffffffff", "-1.8446744073709552e+19"},
+        {"fa47c35000", "100000"},
+        {"f93c00", "1"},
+        {"f97bff", "65504"},
+        {"f90001", "5.960464477539063e-08"},
+        {"f9c400", "-4"},
+        {"f7", "null"},
+        {"9fff", "[]"},
+        {"9f018202039f0405ffff", "[1,[2,3],[4,5]]"},
+        {"bf61610161629f0203ffff", "{\"a\":1,\"b\":[2,3]}"},
+        {"7f657374726561646d696e67ff", "\"streaming\""},
+        {"c074323031332d30332d32315432303a30343a30305a", "\"2013-03-21T20:04:00Z\""},
+        {"c11a514b67b0", "1363896240"},
+    };
+    for (const auto &d : decode) {
+        std::string bytes = FromHex(d.hex);
+        CHECK_EQ(LIT_PARSE_OK, lit.LitParseCbor(&v, bytes.data(), bytes.size()));
+        CHECK_EQ(std::string(d.json), lit.LitStringify(v));
+    }
+
+    CheckBinaryRoundTrip(true, "{\"n\":null,\"b\":[true,false],\"x\":[1e+300,-2.5,70000,-70000,\"\\n\"]}");
+    CheckBinaryRoundTrip(true, "[18446744073709551615,-9223372036854775808,{\"\":{\"\":[]}}]");
+
+    CHECK_CBOR_ERROR(LIT_PARSE_EXPECT_VALUE, "");
+    CHECK_CBOR_ERROR(LIT_PARSE_EXPECT_VALUE, "9f01");
+    CHECK_CBOR_ERROR(LIT_PARSE_EXPECT_VALUE, "9bffffffffffffffff");
+    CHECK_CBOR_ERROR(LIT_PARSE_ROOT_NOT_SINGULAR, "0000");
+    CHECK_CBOR_ERROR(LIT_PARSE_INVALID_VALUE, "4161");   // byte string
+    CHECK_CBOR_ERROR(LIT_PARSE_INVALID_VALUE, "1c");     // reserved additional information
+    CHECK_CBOR_ERROR(LIT_PARSE_INVALID_VALUE, "ff");     // break outside an indefinite item
+    CHECK_CBOR_ERROR(LIT_PARSE_INVALID_VALUE, "f820");   // simple value
+    CHECK_CBOR_ERROR(LIT_PARSE_INVALID_VALUE, "1f");     // indefinite integer
+    CHECK_CBOR_ERROR(LIT_PARSE_INVALID_VALUE, "7f4161ff");
+    CHECK_CBOR_ERROR(LIT_PARSE_MISS_KEY, "a10101");
+    CHECK_CBOR_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "f97c00");
+    CHECK_CBOR_ERROR(LIT_PARSE_NUMBER_TOO_BIG, "f97e00");
+}
+
+static void TestBinary() {
+    TestMsgPack();
+    TestCbor();
+}
+
+// exact counters with LIT_ENABLE_STATS, nothing recorded and no callback without it
+static void TestStats() {
+    std::vector<LitStats> calls;
+    lit_reset_stats();
+    lit_set_stats_callback([&calls](const LitStats &s) { calls.push_back(s); });
+
+    const char *json = "{\"a\":[1,2.5,\"x\\n\"],\"a key longer than the small string buffer\":{\"b\":null,\"c\":true,"
+                       "\"d\":false}} ";
+    LitValue v;
+    CHECK_EQ(LIT_PARSE_OK, lit.LitParse(&v, json));
+    std::string text = lit.LitStringify(v);
+    size_t written = 0;
+    {
+        LitCallbackSink sink([&written](const char *, size_t len) {
+            written += len;
+            return true;
+        });
+        CHECK_EQ(true, lit.LitStringify(v, &sink));
+    }
+    CHECK_EQ(LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lit.LitParse(&v, "[[[1]],[2"));
+    // totals are per thread
+    std::thread([&v]() { lit.LitParse(&v, "[1]"); }).join();
+    LitStats total = lit_get_stats();
+    lit_set_stats_callback(nullptr);
+
+    if (!lit_stats_enabled()) {
+        CHECK_EQ(static_cast<size_t>(0), calls.size());
+        CHECK_EQ(static_cast<uint64_t>(0), total.parses);
+        CHECK_EQ(static_cast<uint64_t>(0), total.bytes_scanned);
+        return;
+    }
+    CHECK_EQ(static_cast<size_t>(5), calls.size());
+    const LitStats &parse = calls[0];
+    CHECK_EQ(static_cast<uint64_t>(1), parse.parses);
+    CHECK_EQ(static_cast<uint64_t>(0), parse.stringifies);
+    CHECK_EQ(static_cast<uint64_t>(strlen(json)), parse.bytes_scanned);
+    CHECK_EQ(static_cast<uint64_t>(1), parse.values[LIT_NULL]);
+    CHECK_EQ(static_cast<uint64_t>(1), parse.values[LIT_FALSE]);
+    CHECK_EQ(static_cast<uint64_t>(1), parse.values[LIT_TRUE]);
+    CHECK_EQ(static_cast<uint64_t>(2), parse.values[LIT_NUMBER]);
+    CHECK_EQ(static_cast<uint64_t>(1), parse.values[LIT_STRING]);
+    CHECK_EQ(static_cast<uint64_t>(1), parse.values[LIT_ARRAY]);
+    CHECK_EQ(static_cast<uint64_t>(2), parse.values[LIT_OBJECT]);
+    CHECK_EQ(static_cast<uint64_t>(2), parse.max_depth);
+    CHECK_EQ(static_cast<uint64_t>(5), parse.strings_plain);
+    CHECK_EQ(static_cast<uint64_t>(1), parse.strings_escaped);
+    // the array and the inner object grow three times, the outer object twice, plus the long key
+    CHECK_EQ(static_cast<uint64_t>(9), parse.allocations);
+    CHECK_EQ(true, parse.bytes_allocated > strlen("a key longer than the small string buffer"));
+
+    CHECK_EQ(static_cast<uint64_t>(1), calls[1].stringifies);
+    CHECK_EQ(static_cast<uint64_t>(text.size()), calls[1].bytes_written);
+    CHECK_EQ(static_cast<uint64_t>(1), calls[1].allocations);
+    CHECK_EQ(static_cast<uint64_t>(text.size()), calls[2].bytes_written);
+    CHECK_EQ(static_cast<uint64_t>(written), calls[2].bytes_written);
+    CHECK_EQ(static_cast<uint64_t>(0), calls[2].allocations);
+
+    // a failed parse still counts what it read
+    CHECK_EQ(static_cast<uint64_t>(3), calls[3].max_depth);
+    CHECK_EQ(static_cast<uint64_t>(2), calls[3].values[LIT_NUMBER]);
+
+    CHECK_EQ(static_cast<uint64_t>(2), total.parses);
+    CHECK_EQ(static_cast<uint64_t>(2), total.stringifies);
+    CHECK_EQ(static_cast<uint64_t>(3), total.max_depth);
+    CHECK_EQ(parse.bytes_scanned + calls[3].bytes_scanned, total.bytes_scanned);
+    CHECK_EQ(static_cast<uint64_t>(2 * text.size()), total.bytes_written);
+    lit_reset_stats();
+    CHECK_EQ(static_cast<uint64_t>(0), lit_get_stats().parses);
+}
+
+// counts what goes through it, new/delete underneath
+class CountingResource : public LitMemoryResource {
+public:
+    size_t allocations = 0;
+    size_t live = 0;
+
+protected:
+    void *DoAllocate(size_t bytes, size_t) override {
+        ++allocations;
+        live += bytes;
+        return ::operator new(bytes);
+    }
+    void DoDeallocate(void *p, size_t bytes, size_t) override {
+        live -= bytes;
+        ::operator delete(p);
+    }
+};
+
+static void TestMemoryResource() {
+    const char *json = "{\"a key longer than the small string buffer\":"
+                       "[1,\"a string longer than the small buffer\",{}],\"b\":{\"c\":[true,null]}}";
+    std::string text;
+    CountingResource pool;
+    LitMemoryResource *resource = &pool;
+    {
+        LitJson plit(resource);
+        CHECK_EQ(resource, plit.lit_get_resource());
+        LitValue v;
+        CHECK_EQ(LIT_PARSE_OK, plit.LitParse(&v, json));
+        text = lit.LitStringify(v);
+        CHECK_EQ(true, pool.allocations > 0);
+        CHECK_EQ(resource, lit.lit_get_object_key(v, 0).get_allocator().lit_get_resource());
+        const LitValue &s = lit.lit_get_array_element(lit.lit_get_object_value(v, 0), 1);
+        CHECK_EQ(resource, lit.lit_get_string(s).get_allocator().lit_get_resource());
+
+        // copies go to the default resource, moves keep their memory
+        size_t allocations = pool.allocations;
+        LitValue c(v);
+        CHECK_EQ(allocations, pool.allocations);
+        CHECK_EQ(lit_get_default_resource(), lit.lit_get_object_key(c, 0).get_allocator().lit_get_resource());
+        LitValue m(std::move(v));
+        CHECK_EQ(allocations, pool.allocations);
+        CHECK_EQ(resource, lit.lit_get_object_key(m, 0).get_allocator().lit_get_resource());
+
+        // LitCopy and the setters copy into the resource
+        LitValue d;
+        plit.LitCopy(&d, c);
+        CHECK_EQ(true, pool.allocations > allocations);
+        CHECK_EQ(text, lit.LitStringify(d));
+        CHECK_EQ(resource, lit.lit_get_object_key(d, 0).get_allocator().lit_get_resource());
+        allocations = pool.allocations;
+        plit.lit_set_string(&d, std::string("a string longer than the small string buffer"));
+        CHECK_EQ(allocations + 1, pool.allocations);
+        CHECK_EQ(std::string("a string longer than the small string buffer"), lit.lit_get_string(d));
+        // a string assigned from a part of itself
+        plit.lit_set_string(&d, lit.lit_get_string(d).data() + 2, 6);
+        CHECK_EQ(std::string("string"), lit.lit_get_string(d));
+
+        // an array of another resource moves its elements into a buffer of ours
+        LitValue::Array a(2);
+        lit.lit_set_string(&a[1], std::string("a string longer than the small string buffer"));
+        allocations = pool.allocations;
+        plit.lit_set_array(&d, std::move(a));
+        CHECK_EQ(allocations + 1, pool.allocations);
+        CHECK_EQ(lit_get_default_resource(),
+                 lit.lit_get_string(lit.lit_get_array_element(d, 1)).get_allocator().lit_get_resource());
+        LitValue::Array b(&pool);
+        b.emplace_back();
+        allocations = pool.allocations;
+        plit.lit_set_array(&d, std::move(b));
+        CHECK_EQ(allocations, pool.allocations);
+        // a string moved in keeps its buffer only when it comes from our resource
+        LitValue::String own("a string longer than the small string buffer", &pool);
+        allocations = pool.allocations;
+        plit.lit_set_string(&d, std::move(own));
+        CHECK_EQ(allocations, pool.allocations);
+        LitValue::String other("a string longer than the small string buffer");
+        plit.lit_set_string(&d, std::move(other));
+        CHECK_EQ(allocations + 1, pool.allocations);
+        CHECK_EQ(resource, lit.lit_get_string(d).get_allocator().lit_get_resource());
+
+        // the lookup index of a large object does not come from its resource
+        std::string wide = "{";
+        for (int i = 0; i < 32; ++i) wide += (i > 0 ? ",\"k" : "\"k") + std::to_string(i) + "\":" + std::to_string(i);
+        wide += "}";
+        LitValue w;
+        CHECK_EQ(LIT_PARSE_OK, plit.LitParse(&w, wide.c_str()));
+        allocations = pool.allocations;
+        CHECK_EQ(static_cast<size_t>(31), lit.lit_find_object_index(w, "k31", 3));
+        CHECK_EQ(allocations, pool.allocations);
+
+        // decoded binary too
+        std::string packed = lit.LitEncodeMsgPack(m);
+        CHECK_EQ(LIT_PARSE_OK, plit.LitParseMsgPack(&d, packed.data(), packed.size()));
+        CHECK_EQ(resource, lit.lit_get_object_key(d, 0).get_allocator().lit_get_resource());
+        std::string cbor = lit.LitEncodeCbor(m);
+        CHECK_EQ(LIT_PARSE_OK, plit.LitParseCbor(&d, cbor.data(), cbor.size()));
+        CHECK_EQ(text, lit.LitStringify(d));
+    }
+    CHECK_EQ(static_cast<size_t>(0), pool.live);
+
+    // a monotonic resource is reused after LitRelease
+    LitMonotonicResource arena(4096);
+    {
+        LitJson alit(&arena);
+        LitValue v;
+        CHECK_EQ(LIT_PARSE_OK, alit.LitParse(&v, json));
+        CHECK_EQ(text, lit.LitStringify(v));
+        CHECK_EQ(true, arena.lit_get_used() > 0);
+    }
+    size_t capacity = arena.lit_get_capacity();
+    arena.LitRelease();
+    CHECK_EQ(static_cast<size_t>(0), arena.lit_get_used());
+    {
+        LitJson alit(&arena);
+        LitValue v;
+        CHECK_EQ(LIT_PARSE_OK, alit.LitParse(&v, json));
+        CHECK_EQ(capacity, arena.lit_get_capacity());
+    }
+    arena.LitRelease();
+
+    // the default resource is picked up by LitJson and allocators made after setting it
+    CHECK_EQ(lit_get_new_delete_resource(), lit_set_default_resource(&pool));
+    {
+        LitJson dlit;
+        CHECK_EQ(resource, dlit.lit_get_resource());
+        LitValue v;
+        CHECK_EQ(LIT_PARSE_OK, dlit.LitParse(&v, json));
+        CHECK_EQ(resource, LitValue::String().get_allocator().lit_get_resource());
+
+        // so are the trees built from a tape and by LitExtract
+        LitTapeDocument doc;
+        CHECK_EQ(LIT_PARSE_OK, doc.LitParse(json));
+        doc.lit_to_value(doc.lit_get_root(), &v);
+        CHECK_EQ(resource, lit.lit_get_object_key(v, 0).get_allocator().lit_get_resource());
+        LitPointer p;
+        CHECK_EQ(true, p.LitCompile("/b"));
+        std::vector<LitValue> found;
+        CHECK_EQ(LIT_PARSE_OK, p.LitExtract(json, &found));
+        CHECK_EQ(resource, lit.lit_get_object_key(found[0], 0).get_allocator().lit_get_resource());
+    }
+    CHECK_EQ(resource, lit_set_default_resource(nullptr));
+    CHECK_EQ(lit_get_new_delete_resource(), lit_get_default_resource());
+    CHECK_EQ(lit_get_new_delete_resource(), lit.lit_get_resource());
+    CHECK_EQ(static_cast<size_t>(0), pool.live);
 }
 
 int main() {
     TestParse();
     TestStringify();
+    TestBinary();
+    TestStats();
+    TestMemoryResource();
 
     std::cout << test_pass << "/" << test_count;
     std::cout << std::fixed << std::setprecision(2) << " (" << test_pass * 100.0 / test_count << "%) passed"
@@ -0,0 +1,49 @@
+#include "LitArena.h"
+
+#include <cstdlib>
+#include <new>
+
+static const size_t kAlign = alignof(std::max_align_t);
+const size_t LitArena::kHeaderSize = (sizeof(LitArena::Chunk) + kAlign - 1) & ~(kAlign - 1);
+
+void* LitArena::Allocate(size_t size) {
+    size = (size + kAlign - 1) & ~(kAlign - 1);
+    if (static_cast<size_t>(end - ptr) < size) AddChunk(size > chunk_size ? size : chunk_size);
+
+    void* p = ptr;
+    ptr += size;
+    used += size;
+    return p;
+}
+
+void LitArena::Reset() {
+    if (head == nullptr) return;
+    if (head->next != nullptr) {
+        size_t total = capacity;
+        Release();
+        AddChunk(total);
+    }
+    ptr = reinterpret_cast<char*>(head) + kHeaderSize;
+    used = 0;
+}
+
+void LitArena::Release() {
+    while (head != nullptr) {
+        Chunk* next = head->next;
+        free(head);
+        head = next;
+    }
+    ptr = end = nullptr;
+    capacity = used = 0;
+}
+
+void LitArena::AddChunk(size_t size) {
+    Chunk* c = static_cast<Chunk*>(malloc(kHeaderSize + size));
+    if (c == nullptr) throw std::bad_alloc();
+    c->next = head;
+    c->size = size;
+    head = c;
+    ptr = reinterpret_cast<char*>(c) + kHeaderSize;
+    end = ptr + size;
+    capacity += size;
+}
@@ -0,0 +1,45 @@
+#ifndef LITARENA_H_
+#define LITARENA_H_
+
+#include <cstddef>
+
+// Bump allocator: memory is carved sequentially out of large chunks and is only ever released all at once.
+class LitArena {
+public:
+    static const size_t kDefaultChunkSize = 64 * 1024;
+
+    explicit LitArena(size_t chunk_size = kDefaultChunkSize) : chunk_size(chunk_size) {}
+    LitArena(const LitArena&) = delete;
+    LitArena& operator=(const LitArena&) = delete;
+    ~LitArena() { Release(); }
+
+    // returned memory is aligned for any scalar type and stays valid until Reset() or Release()
+    void* Allocate(size_t size);
+    // drop every allocation but keep the memory for reuse, chunks are merged into one so that a document of the
+    // same size fits without touching malloc again
+    void Reset();
+    // give all memory back to the system
+    void Release();
+
+    size_t Capacity() const { return capacity; }
+    size_t Used() const { return used; }
+
+private:
+    struct Chunk {
+        Chunk* next;
+        size_t size;
+    };
+
+    static const size_t kHeaderSize;
+
+    void AddChunk(size_t size);
+
+    Chunk* head = nullptr;  // most recent chunk, allocations are served from here
+    char* ptr = nullptr;
+    char* end = nullptr;
+    size_t chunk_size;
+    size_t capacity = 0;
+    size_t used = 0;
+};
+
+#endif
@@ -0,0 +1,495 @@
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#include "LitJson.h"
+#include "LitSink.h"
+
+// integers are stored like LitParse stores them: as int64 whenever they fit
+static void LitSetUnsigned(LitValue* v, uint64_t u) {
+    if (u <= static_cast<uint64_t>(INT64_MAX)) {
+        *v = static_cast<int64_t>(u);
+    } else {
+        *v = u;
+    }
+}
+
+// a text number can't be NaN or infinite, so neither can a decoded one
+static ParseResultType LitSetFloat(LitValue* v, double d) {
+    if (!std::isfinite(d)) return LIT_PARSE_NUMBER_TOO_BIG;
+    *v = d;
+    return LIT_PARSE_OK;
+}
+
+static double LitFloatFromBits(uint64_t bits) {
+    uint32_t b = static_cast<uint32_t>(bits);
+    float f;
+    memcpy(&f, &b, sizeof(f));
+    return f;
+}
+
+static double LitDoubleFromBits(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// IEEE 754 half precision, CBOR's smallest float
+static double LitHalfFromBits(uint64_t bits) {
+    int exp = (bits >> 10) & 0x1F;
+    int man = bits & 0x3FF;
+    double d;
+    if (exp == 0) {
+        d = std::ldexp(man, -24);
+    } else if (exp != 31) {
+        d = std::ldexp(man + 1024, exp - 25);
+    } else {
+        d = man == 0 ? INFINITY : NAN;
+    }
+    return bits & 0x8000 ? -d : d;
+}
+
+static bool LitIsFloat(double d) { return std::fabs(d) <= FLT_MAX && static_cast<double>(static_cast<float>(d)) == d; }
+
+static uint64_t LitFloatBits(double d) {
+    float f = static_cast<float>(d);
+    uint32_t b;
+    memcpy(&b, &f, sizeof(b));
+    return b;
+}
+
+static uint64_t LitDoubleBits(double d) {
+    uint64_t b;
+    memcpy(&b, &d, sizeof(b));
+    return b;
+}
+
+// MessagePack
+
+ParseResultType LitJson::LitParseMsgPack(LitValue* v, const char* data, size_t len) const {
+    assert(v != nullptr && (data != nullptr || len == 0));
+    LitBinaryContext c;
+    c.cur = reinterpret_cast<const unsigned char*>(data);
+    c.end = c.cur + len;
+    ParseResultType res = LitParseMsgPackValue(&c, v);
+    if (res == LIT_PARSE_OK && c.cur != c.end) res = LIT_PARSE_ROOT_NOT_SINGULAR;
+    if (res != LIT_PARSE_OK) lit_set_null(v);
+    return res;
+}
+
+ParseResultType LitJson::LitParseMsgPackString(LitBinaryContext* c, LitValue::String* s) const {
+    if (c->cur == c->end) return LIT_PARSE_EXPECT_VALUE;
+    unsigned char b = *c->cur++;
+    uint64_t n = b & 0x1F;
+    if ((b & 0xE0) != 0xA0) {
+        // str 8, 16 and 32
+        if (b < 0xD9 || b > 0xDB) return LIT_PARSE_MISS_KEY;
+        if (!c->LitReadUint(1 << (b - 0xD9), &n)) return LIT_PARSE_EXPECT_VALUE;
+    }
+    return c->LitReadBytes(n, s) ? LIT_PARSE_OK : LIT_PARSE_EXPECT_VALUE;
+}
+
+ParseResultType LitJson::LitParseMsgPackValue(LitBinaryContext* c, LitValue* v) const {
+    if (c->cur == c->end) return LIT_PARSE_EXPECT_VALUE;
+    unsigned char b = *c->cur;
+    if ((b & 0xE0) == 0xA0 || (b >= 0xD9 && b <= 0xDB)) {
+        LitValue::String s(resource);
+        ParseResultType res = LitParseMsgPackString(c, &s);
+        if (res == LIT_PARSE_OK) LitSetString(v, std::move(s));
+        return res;
+    }
+
+    ++c->cur;
+    uint64_t n = 0;
+    bool object = false;
+    if (b <= 0x7F || b >= 0xE0) {
+        // positive and negative fixint
+        *v = static_cast<int64_t>(static_cast<int8_t>(b));
+        return LIT_PARSE_OK;
+    } else if (b <= 0x8F) {
+        n = b & 0x0F;
+        object = true;
+    } else if (b <= 0x9F) {
+        n = b & 0x0F;
+    } else {
+        switch (b) {
+            case 0xC0: lit_set_null(v); return LIT_PARSE_OK;
+            case 0xC2: lit_set_boolean(v, false); return LIT_PARSE_OK;
+            case 0xC3: lit_set_boolean(v, true); return LIT_PARSE_OK;
+            case 0xCA:
+                if (!c->LitReadUint(4, &n)) return LIT_PARSE_EXPECT_VALUE;
+                return LitSetFloat(v, LitFloatFromBits(n));
+            case 0xCB:
+                if (!c->LitReadUint(8, &n)) return LIT_PARSE_EXPECT_VALUE;
+                return LitSetFloat(v, LitDoubleFromBits(n));
+            case 0xCC:
+            case 0xCD:
+            case 0xCE:
+            case 0xCF:
+                if (!c->LitReadUint(1 << (b - 0xCC), &n)) return LIT_PARSE_EXPECT_VALUE;
+                LitSetUnsigned(v, n);
+                return LIT_PARSE_OK;
+            case 0xD0:
+            case 0xD1:
+            case 0xD2:
+            case 0xD3: {
+                int bytes = 1 << (b - 0xD0);
+                if (!c->LitReadUint(bytes, &n)) return LIT_PARSE_EXPECT_VALUE;
+                // sign-extend from the top bit that was read
+                uint64_t sign = uint64_t(1) << (bytes * 8 - 1);
+                *v = static_cast<int64_t>((n ^ sign) - sign);
+                return LIT_PARSE_OK;
+            }
+            case 0xDC:
+            case 0xDD:
+                if (!c->LitReadUint(b == 0xDC ? 2 : 4, &n)) return LIT_PARSE_EXPECT_VALUE;
+                break;
+            case 0xDE:
+            case 0xDF:
+                if (!c->LitReadUint(b == 0xDE ? 2 : 4, &n)) return LIT_PARSE_EXPECT_VALUE;
+                object = true;
+                break;
+            default:
+                // never used (0xC1), bin and ext have no JSON counterpart
+                return LIT_PARSE_INVALID_VALUE;
+        }
+    }
+
+    if (++c->depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+    ParseResultType res;
+    if (!object) {
+        LitValue::Array aux(resource);
+        aux.reserve(c->LitCapacity(n, 1));
+        for (; n > 0; --n) {
+            aux.emplace_back();
+            if ((res = LitParseMsgPackValue(c, &aux.back())) != LIT_PARSE_OK) return res;
+        }
+        LitSetArray(v, std::move(aux));
+    } else {
+        LitValue::Obj aux(resource);
+        aux.reserve(c->LitCapacity(n, 2));
+        for (; n > 0; --n) {
+            aux.emplace_back(LitValue::String(resource), LitValue());
+            if ((res = LitParseMsgPackString(c, &aux.back().first)) != LIT_PARSE_OK) return res;
+            if ((res = LitParseMsgPackValue(c, &aux.back().second)) != LIT_PARSE_OK) return res;
+        }
+        LitSetObject(v, std::move(aux));
+    }
+    --c->depth;
+    return LIT_PARSE_OK;
+}
+
+// the head byte and then the low bytes of x, big-endian
+template <typename Buffer>
+static void LitPutHead(Buffer* res, unsigned head, uint64_t x, int bytes) {
+    char buff[9];
+    buff[0] = static_cast<char>(head);
+    for (int i = bytes; i > 0; --i, x >>= 8) buff[i] = static_cast<char>(x & 0xFF);
+    res->append(buff, bytes + 1);
+}
+
+// fix form below limit, then the 8- (if there is one), 16- and 32-bit forms
+template <typename Buffer>
+static void LitPutMsgPackLength(Buffer* res, unsigned fix, size_t limit, unsigned head8, unsigned head16, size_t n) {
+    assert(static_cast<uint64_t>(n) <= 0xFFFFFFFFu);
+    if (n < limit) {
+        res->push_back(static_cast<char>(fix | n));
+    } else if (head8 != 0 && n <= 0xFF) {
+        LitPutHead(res, head8, n, 1);
+    } else if (n <= 0xFFFF) {
+        LitPutHead(res, head16, n, 2);
+    } else {
+        LitPutHead(res, head16 + 1, n, 4);
+    }
+}
+
+template <typename Buffer>
+static void LitPutMsgPackUint(Buffer* res, uint64_t u) {
+    if (u <= 0x7F) {
+        res->push_back(static_cast<char>(u));
+    } else if (u <= 0xFF) {
+        LitPutHead(res, 0xCC, u, 1);
+    } else if (u <= 0xFFFF) {
+        LitPutHead(res, 0xCD, u, 2);
+    } else if (u <= 0xFFFFFFFFu) {
+        LitPutHead(res, 0xCE, u, 4);
+    } else {
+        LitPutHead(res, 0xCF, u, 8);
+    }
+}
+
+template <typename Buffer>
+static void LitPutMsgPackInt(Buffer* res, int64_t i) {
+    if (i >= 0) {
+        LitPutMsgPackUint(res, static_cast<uint64_t>(i));
+    } else if (i >= -32) {
+        res->push_back(static_cast<char>(i));
+    } else if (i >= INT8_MIN) {
+        LitPutHead(res, 0xD0, static_cast<uint64_t>(i), 1);
+    } else if (i >= INT16_MIN) {
+        LitPutHead(res, 0xD1, static_cast<uint64_t>(i), 2);
+    } else if (i >= INT32_MIN) {
+        LitPutHead(res, 0xD2, static_cast<uint64_t>(i), 4);
+    } else {
+        LitPutHead(res, 0xD3, static_cast<uint64_t>(i), 8);
+    }
+}
+
+template <typename Buffer>
+static void LitPutMsgPackString(Buffer* res, const LitValue::String& s) {
+    LitPutMsgPackLength(res, 0xA0, 32, 0xD9, 0xDA, s.size());
+    res->append(s.data(), s.size());
+}
+
+std::string LitJson::LitEncodeMsgPack(const LitValue& v) const {
+    std::string res;
+    LitEncodeMsgPackValue(v, &res);
+    return res;
+}
+
+bool LitJson::LitEncodeMsgPack(const LitValue& v, LitSink* sink) const {
+    assert(sink != nullptr);
+    LitEncodeMsgPackValue(v, sink);
+    return sink->LitFlush();
+}
+
+template <typename Buffer>
+void LitJson::LitEncodeMsgPackValue(const LitValue& v, Buffer* res) const {
+    switch (v.type) {
+        case LIT_NULL: res->push_back(static_cast<char>(0xC0)); break;
+        case LIT_FALSE: res->push_back(static_cast<char>(0xC2)); break;
+        case LIT_TRUE: res->push_back(static_cast<char>(0xC3)); break;
+        case LIT_NUMBER:
+            switch (v.num_type) {
+                case LIT_NUMBER_DOUBLE:
+                    if (LitIsFloat(v.n)) {
+                        LitPutHead(res, 0xCA, LitFloatBits(v.n), 4);
+                    } else {
+                        LitPutHead(res, 0xCB, LitDoubleBits(v.n), 8);
+                    }
+                    break;
+                case LIT_NUMBER_INT64: LitPutMsgPackInt(res, v.i); break;
+                case LIT_NUMBER_UINT64: LitPutMsgPackUint(res, v.u); break;
+            }
+            break;
+        case LIT_STRING: LitPutMsgPackString(res, v.str); break;
+        case LIT_ARRAY:
+            LitPutMsgPackLength(res, 0x90, 16, 0, 0xDC, v.arr.size());
+            for (const LitValue& e : v.arr) LitEncodeMsgPackValue(e, res);
+            break;
+        case LIT_OBJECT:
+            LitPutMsgPackLength(res, 0x80, 16, 0, 0xDE, v.obj.members.size());
+            for (const auto& m : v.obj.members) {
+                LitPutMsgPackString(res, m.first);
+                LitEncodeMsgPackValue(m.second, res);
+            }
+            break;
+    }
+}
+
+// CBOR
+
+ParseResultType LitJson::LitParseCbor(LitValue* v, const char* data, size_t len) const {
+    assert(v != nullptr && (data != nullptr || len == 0));
+    LitBinaryContext c;
+    c.cur = reinterpret_cast<const unsigned char*>(data);
+    c.end = c.cur + len;
+    ParseResultType res = LitParseCborValue(&c, v);
+    if (res == LIT_PARSE_OK && c.cur != c.end) res = LIT_PARSE_ROOT_NOT_SINGULAR;
+    if (res != LIT_PARSE_OK) lit_set_null(v);
+    return res;
+}
+
+ParseResultType LitJson::LitParseCborHead(LitBinaryContext* c, unsigned* major, uint64_t* n, bool* indefinite) {
+    if (c->cur == c->end) return LIT_PARSE_EXPECT_VALUE;
+    unsigned char b = *c->cur++;
+    unsigned ai = b & 0x1F;
+    *major = b >> 5;
+    *n = ai;
+    *indefinite = ai == 31;
+    if (ai < 24 || ai == 31) return LIT_PARSE_OK;
+    // 28 to 30 are reserved
+    if (ai > 27) return LIT_PARSE_INVALID_VALUE;
+    return c->LitReadUint(1 << (ai - 24), n) ? LIT_PARSE_OK : LIT_PARSE_EXPECT_VALUE;
+}
+
+ParseResultType LitJson::LitParseCborString(LitBinaryContext* c, LitValue::String* s) const {
+    unsigned major;
+    uint64_t n;
+    bool indefinite;
+    ParseResultType res = LitParseCborHead(c, &major, &n, &indefinite);
+    if (res != LIT_PARSE_OK) return res;
+    if (major != 3) return LIT_PARSE_MISS_KEY;
+    if (!indefinite) return c->LitReadBytes(n, s) ? LIT_PARSE_OK : LIT_PARSE_EXPECT_VALUE;
+    // definite text strings up to a break, concatenated
+    while (true) {
+        if (c->cur == c->end) return LIT_PARSE_EXPECT_VALUE;
+        if (*c->cur == 0xFF) {
+            ++c->cur;
+            return LIT_PARSE_OK;
+        }
+        if ((res = LitParseCborHead(c, &major, &n, &indefinite)) != LIT_PARSE_OK) return res;
+        if (major != 3 || indefinite) return LIT_PARSE_INVALID_VALUE;
+        if (!c->LitReadBytes(n, s)) return LIT_PARSE_EXPECT_VALUE;
+    }
+}
+
+ParseResultType LitJson::LitParseCborValue(LitBinaryContext* c, LitValue* v) const {
+    const unsigned char* head = c->cur;
+    unsigned major;
+    uint64_t n;
+    bool indefinite;
+    ParseResultType res = LitParseCborHead(c, &major, &n, &indefinite);
+    if (res != LIT_PARSE_OK) return res;
+    switch (major) {
+        case 0:
+            if (indefinite) return LIT_PARSE_INVALID_VALUE;
+            LitSetUnsigned(v, n);
+            return LIT_PARSE_OK;
+        case 1:
+            // -1 - n, below INT64_MIN only a double can hold it, like a text number
+            if (indefinite) return LIT_PARSE_INVALID_VALUE;
+            if (n <= static_cast<uint64_t>(INT64_MAX)) {
+                *v = -1 - static_cast<int64_t>(n);
+            } else {
+                *v = -1.0 - static_cast<double>(n);
+            }
+            return LIT_PARSE_OK;
+        case 3: {
+            c->cur = head;
+            LitValue::String s(resource);
+            if ((res = LitParseCborString(c, &s)) == LIT_PARSE_OK) LitSetString(v, std::move(s));
+            return res;
+        }
+        case 4: {
+            if (++c->depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+            LitValue::Array aux(resource);
+            aux.reserve(indefinite ? 0 : c->LitCapacity(n, 1));
+            for (uint64_t i = 0; indefinite || i < n; ++i) {
+                if (indefinite && c->cur != c->end && *c->cur == 0xFF) {
+                    ++c->cur;
+                    break;
+                }
+                aux.emplace_back();
+                if ((res = LitParseCborValue(c, &aux.back())) != LIT_PARSE_OK) return res;
+            }
+            LitSetArray(v, std::move(aux));
+            --c->depth;
+            return LIT_PARSE_OK;
+        }
+        case 5: {
+            if (++c->depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+            LitValue::Obj aux(resource);
+            aux.reserve(indefinite ? 0 : c->LitCapacity(n, 2));
+            for (uint64_t i = 0; indefinite || i < n; ++i) {
+                if (indefinite && c->cur != c->end && *c->cur == 0xFF) {
+                    ++c->cur;
+                    break;
+                }
+                aux.emplace_back(LitValue::String(resource), LitValue());
+                if ((res = LitParseCborString(c, &aux.back().first)) != LIT_PARSE_OK) return res;
+                if ((res = LitParseCborValue(c, &aux.back().second)) != LIT_PARSE_OK) return res;
+            }
+            LitSetObject(v, std::move(aux));
+            --c->depth;
+            return LIT_PARSE_OK;
+        }
+        case 6: {
+            // a tag, the item follows. Chained tags nest like containers.
+            if (indefinite) return LIT_PARSE_INVALID_VALUE;
+            if (++c->depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+            if ((res = LitParseCborValue(c, v)) == LIT_PARSE_OK) --c->depth;
+            return res;
+        }
+        case 7:
+            switch (*head & 0x1F) {
+                case 20: lit_set_boolean(v, false); return LIT_PARSE_OK;
+                case 21: lit_set_boolean(v, true); return LIT_PARSE_OK;
+                case 22:
+                case 23: lit_set_null(v); return LIT_PARSE_OK;
+                case 25: return LitSetFloat(v, LitHalfFromBits(n));
+                case 26: return LitSetFloat(v, LitFloatFromBits(n));
+                case 27: return LitSetFloat(v, LitDoubleFromBits(n));
+                default: return LIT_PARSE_INVALID_VALUE;
+            }
+        default:
+            // byte strings
+            return LIT_PARSE_INVALID_VALUE;
+    }
+}
+
+template <typename Buffer>
+static void LitPutCborHead(Buffer* res, unsigned major, uint64_t n) {
+    unsigned m = major << 5;
+    if (n < 24) {
+        res->push_back(static_cast<char>(m | n));
+    } else if (n <= 0xFF) {
+        LitPutHead(res, m | 24, n, 1);
+    } else if (n <= 0xFFFF) {
+        LitPutHead(res, m | 25, n, 2);
+    } else if (n <= 0xFFFFFFFFu) {
+        LitPutHead(res, m | 26, n, 4);
+    } else {
+        LitPutHead(res, m | 27, n, 8);
+    }
+}
+
+template <typename Buffer>
+static void LitPutCborString(Buffer* res, const LitValue::String& s) {
+    LitPutCborHead(res, 3, s.size());
+    res->append(s.data(), s.size());
+}
+
+std::string LitJson::LitEncodeCbor(const LitValue& v) const {
+    std::string res;
+    LitEncodeCborValue(v, &res);
+    return res;
+}
+
+bool LitJson::LitEncodeCbor(const LitValue& v, LitSink* sink) const {
+    assert(sink != nullptr);
+    LitEncodeCborValue(v, sink);
+    return sink->LitFlush();
+}
+
+template <typename Buffer>
+void LitJson::LitEncodeCborValue(const LitValue& v, Buffer* res) const {
+    switch (v.type) {
+        case LIT_NULL: res->push_back(static_cast<char>(0xF6)); break;
+        case LIT_FALSE: res->push_back(static_cast<char>(0xF4)); break;
+        case LIT_TRUE: res->push_back(static_cast<char>(0xF5)); break;
+        case LIT_NUMBER:
+            switch (v.num_type) {
+                case LIT_NUMBER_DOUBLE:
+                    if (LitIsFloat(v.n)) {
+                        LitPutHead(res, 0xFA, LitFloatBits(v.n), 4);
+                    } else {
+                        LitPutHead(res, 0xFB, LitDoubleBits(v.n), 8);
+                    }
+                    break;
+                case LIT_NUMBER_INT64:
+                    // a negative i is stored as -1 - i, which is ~i
+                    if (v.i >= 0) {
+                        LitPutCborHead(res, 0, static_cast<uint64_t>(v.i));
+                    } else {
+                        LitPutCborHead(res, 1, ~static_cast<uint64_t>(v.i));
+                    }
+                    break;
+                case LIT_NUMBER_UINT64: LitPutCborHead(res, 0, v.u); break;
+            }
+            break;
+        case LIT_STRING: LitPutCborString(res, v.str); break;
+        case LIT_ARRAY:
+            LitPutCborHead(res, 4, v.arr.size());
+            for (const LitValue& e : v.arr) LitEncodeCborValue(e, res);
+            break;
+        case LIT_OBJECT:
+            LitPutCborHead(res, 5, v.obj.members.size());
+            for (const auto& m : v.obj.members) {
+                LitPutCborString(res, m.first);
+                LitEncodeCborValue(m.second, res);
+            }
+            break;
+    }
+}
@@ -0,0 +1,224 @@
+#include "LitDecode.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+#include "LitNumber.h"
+#include "LitSimd.h"
+
+static inline bool LitIsDigit(char ch) { return ch >= '0' && ch <= '9'; }
+
+// integer lexemes that fit in 64 bits never touch the floating point path
+static inline bool LitDecodeInteger(uint64_t man, const char* first, const char* last, bool neg,
+                                    LitDecodedNumber* num) {
+    // man holds the first 19 digits, only UINT64_MAX's 20 digits can still fit
+    size_t len = last - first;
+    if (len == 20) {
+        unsigned d = last[-1] - '0';
+        if (man > UINT64_MAX / 10 || (man == UINT64_MAX / 10 && d > UINT64_MAX % 10)) return false;
+        man = man * 10 + d;
+    } else if (len > 20) {
+        return false;
+    }
+
+    if (!neg) {
+        if (man <= static_cast<uint64_t>(INT64_MAX)) {
+            num->type = LIT_NUMBER_INT64;
+            num->i = static_cast<int64_t>(man);
+        } else {
+            num->type = LIT_NUMBER_UINT64;
+            num->u = man;
+        }
+        return true;
+    }
+    // -0 is a double
+    if (man == 0 || man > static_cast<uint64_t>(INT64_MAX) + 1) return false;
+    num->type = LIT_NUMBER_INT64;
+    num->i = man == static_cast<uint64_t>(INT64_MAX) + 1 ? INT64_MIN : -static_cast<int64_t>(man);
+    return true;
+}
+
+ParseResultType LitDecodeNumber(const char** cur, LitDecodedNumber* num) {
+    const char* p = *cur;
+    uint64_t man = 0;  // first 19 significant digits
+    int digits = 0;
+    int exp10 = 0;
+    bool truncated = false;
+
+    // skip '-'
+    bool neg = *p == '-';
+    if (neg) ++p;
+
+    // parse number
+    const char* int_first = p;
+    if (*p == '0') {
+        ++p;
+    } else {
+        if (!LitIsDigit(*p)) return LIT_PARSE_INVALID_VALUE;
+        for (; LitIsDigit(*p); ++p) {
+            if (digits < 19) {
+                man = man * 10 + (*p - '0');
+                ++digits;
+            } else {
+                ++exp10;
+                if (*p != '0') truncated = true;
+            }
+        }
+    }
+
+    if (*p != '.' && *p != 'e' && *p != 'E' && LitDecodeInteger(man, int_first, p, neg, num)) {
+        *cur = p;
+        return LIT_PARSE_OK;
+    }
+
+    // parse '.'
+    if (*p == '.') {
+        ++p;
+        if (!LitIsDigit(*p)) return LIT_PARSE_INVALID_VALUE;
+        for (; LitIsDigit(*p); ++p) {
+            if (man == 0 && *p == '0') {
+                // leading zero, not significant
+                --exp10;
+            } else if (digits < 19) {
+                man = man * 10 + (*p - '0');
+                ++digits;
+                --exp10;
+            } else if (*p != '0') {
+                truncated = true;
+            }
+        }
+    }
+
+    // parse 'e' or 'E'
+    if (*p == 'e' || *p == 'E') {
+        ++p;
+        bool eneg = false;
+        if (*p == '-' || *p == '+') eneg = *p++ == '-';
+        if (!LitIsDigit(*p)) return LIT_PARSE_INVALID_VALUE;
+        int e = 0;
+        for (; LitIsDigit(*p); ++p) {
+            // anything past this over- or underflows anyway
+            if (e < 100000) e = e * 10 + (*p - '0');
+        }
+        exp10 += eneg ? -e : e;
+    }
+
+    // check range error
+    num->type = LIT_NUMBER_DOUBLE;
+    num->d = LitNumberToDouble(man, exp10, neg, truncated, *cur, p);
+    if (num->d == HUGE_VAL || num->d == -HUGE_VAL) return LIT_PARSE_NUMBER_TOO_BIG;
+
+    *cur = p;
+    return LIT_PARSE_OK;
+}
+
+// string scan
+static const char* LitScanStringScalar(const char* p) {
+    while (true) {
+        unsigned char ch = static_cast<unsigned char>(*p);
+        if (ch == '\"' || ch == '\\' || ch < 0x20) return p;
+        ++p;
+    }
+}
+
+#ifdef LIT_HAS_SSE2
+LIT_NO_SANITIZE_ADDRESS static inline uint32_t LitClassify16(const char* a) {
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i bslash = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1F);
+    __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(a));
+    // x <= 0x1F as unsigned bytes
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, bslash));
+    m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_min_epu8(x, ctrl), x));
+    return static_cast<uint32_t>(_mm_movemask_epi8(m));
+}
+
+LIT_NO_SANITIZE_ADDRESS static const char* LitScanStringSSE2(const char* p) {
+    size_t offset = reinterpret_cast<uintptr_t>(p) & 15;
+    const char* a = p - offset;
+    uint32_t mask = LitClassify16(a) & (0xFFFFu << offset);
+    while (mask == 0) {
+        a += 16;
+        mask = LitClassify16(a);
+    }
+    return a + LitCountTrailingZero(mask);
+}
+#endif
+
+#ifdef LIT_HAS_AVX2
+LIT_TARGET_AVX2 LIT_NO_SANITIZE_ADDRESS static inline uint32_t LitClassify32(const char* a) {
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i bslash = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1F);
+    __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(a));
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, bslash));
+    m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_min_epu8(x, ctrl), x));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+
+LIT_TARGET_AVX2 LIT_NO_SANITIZE_ADDRESS static const char* LitScanStringAVX2(const char* p) {
+    size_t offset = reinterpret_cast<uintptr_t>(p) & 31;
+    const char* a = p - offset;
+    uint32_t mask = LitClassify32(a) & (0xFFFFFFFFu << offset);
+    while (mask == 0) {
+        a += 32;
+        mask = LitClassify32(a);
+    }
+    return a + LitCountTrailingZero(mask);
+}
+#endif
+
+typedef const char* (*LitScanStringFn)(const char*);
+
+static LitScanStringFn LitSelectScanString(LitSimdLevel level) {
+    switch (level) {
+#ifdef LIT_HAS_AVX2
+        case LIT_SIMD_AVX2: return LitScanStringAVX2;
+#endif
+#ifdef LIT_HAS_SSE2
+        case LIT_SIMD_SSE2: return LitScanStringSSE2;
+#endif
+        default: return LitScanStringScalar;
+    }
+}
+
+static LitSimdLevel LitSupportedSimdLevel() {
+    static const LitSimdLevel supported = LitDetectSimdLevel();
+    return supported;
+}
+
+static const char* LitScanStringFirstUse(const char* p);
+
+// both start out constant-initialized, so a parse running during static initialization still works
+static std::atomic<LitSimdLevel> simd_level(LIT_SIMD_NONE);
+static std::atomic<LitScanStringFn> scan_string(LitScanStringFirstUse);
+
+static const char* LitScanStringFirstUse(const char* p) {
+    lit_set_simd_level(LitSupportedSimdLevel());
+    return scan_string.load(std::memory_order_relaxed)(p);
+}
+
+LitSimdLevel lit_get_simd_level() {
+    if (scan_string.load(std::memory_order_relaxed) == LitScanStringFirstUse) {
+        lit_set_simd_level(LitSupportedSimdLevel());
+    }
+    return simd_level.load(std::memory_order_relaxed);
+}
+
+LitSimdLevel lit_set_simd_level(LitSimdLevel level) {
+    LitSimdLevel supported = LitSupportedSimdLevel();
+    if (level > supported) level = supported;
+    simd_level.store(level, std::memory_order_relaxed);
+    scan_string.store(LitSelectScanString(level), std::memory_order_relaxed);
+    return level;
+}
+
+const char* LitScanString(const char* p) {
+    // most keys and many values are short, look at a few bytes before paying for a vector scan
+    for (int i = 0; i < 8; ++i, ++p) {
+        unsigned char ch = static_cast<unsigned char>(*p);
+        if (ch == '\"' || ch == '\\' || ch < 0x20) return p;
+    }
+    return scan_string.load(std::memory_order_relaxed)(p);
+}
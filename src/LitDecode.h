@@ -0,0 +1,148 @@
+#ifndef LITDECODE_H_
+#define LITDECODE_H_
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#include "LitJson.h"
+
+// Token decoders shared by every parser (LitJson, LitDocument). A decoder starts at *cur and, on success,
+// leaves *cur right after the token.
+
+inline bool LitIsWhitespace(char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r'; }
+
+// characters LitDecodeNumber may consume, a number token ends at the first other one
+inline bool LitIsNumberChar(char ch) {
+    return (ch >= '0' && ch <= '9') || ch == '-' || ch == '+' || ch == '.' || ch == 'e' || ch == 'E';
+}
+
+// a decoded number, type says which member is set (see LitNumberType)
+struct LitDecodedNumber {
+    LitNumberType type;
+    union {
+        double d;
+        int64_t i;
+        uint64_t u;
+    };
+};
+
+// parse a number, *cur points at its first character
+ParseResultType LitDecodeNumber(const char** cur, LitDecodedNumber* num);
+
+// String scanners used by LitDecodeString, from slowest to fastest. The best one the CPU supports is picked on
+// first use, lit_set_simd_level can lower it (e.g. to compare against the scalar loop) but never raise it past
+// what the CPU can run. Call it before parsing starts, it is not synchronized with running parsers.
+enum LitSimdLevel { LIT_SIMD_NONE, LIT_SIMD_SSE2, LIT_SIMD_AVX2 };
+
+LitSimdLevel lit_get_simd_level();
+LitSimdLevel lit_set_simd_level(LitSimdLevel level);
+
+// return the first character at or after p that ends a run of plain string characters: '\"', '\\' or a control
+// character (including the terminating '\0')
+const char* LitScanString(const char* p);
+
+inline const char* LitDecodeUnicode(const char* p, unsigned int* u) {
+    *u = 0;
+    for (int i = 0; i < 4; ++i) {
+        char ch = *p++;
+        *u <<= 4;
+        if (ch >= '0' && ch <= '9') {
+            *u |= ch - '0';
+        } else if (ch >= 'A' && ch <= 'F') {
+            *u |= ch - 'A' + 10;
+        } else if (ch >= 'a' && ch <= 'f') {
+            *u |= ch - 'a' + 10;
+        } else {
+            return nullptr;
+        }
+    }
+    return p;
+}
+
+template <typename Buffer>
+inline void LitEncodeUTF8(Buffer* buff, unsigned int u) {
+    if (u <= 0x7F) {
+        buff->push_back(u);
+    } else if (u <= 0x7FF) {
+        buff->push_back(0xC0 | ((u >> 6) & 0xFF));
+        buff->push_back(0x80 | (u & 0x3F));
+    } else if (u <= 0xFFFF) {
+        buff->push_back(0xE0 | ((u >> 12) & 0xFF));
+        buff->push_back(0x80 | ((u >> 6) & 0x3F));
+        buff->push_back(0x80 | (u & 0x3F));
+    } else {
+        assert(u <= 0x10FFFF);
+        buff->push_back(0xF0 | ((u >> 18) & 0xFF));
+        buff->push_back(0x80 | ((u >> 12) & 0x3F));
+        buff->push_back(0x80 | ((u >> 6) & 0x3F));
+        buff->push_back(0x80 | (u & 0x3F));
+    }
+}
+
+// Buffer for LitDecodeString that writes the decoded characters back into the source text. Decoding never
+// produces more bytes than it consumes, so the write position can't overtake the read position.
+struct LitInsituBuffer {
+    explicit LitInsituBuffer(char* p) : w(p) {}
+    void push_back(char ch) { *w++ = ch; }
+    void append(const char* s, size_t n) {
+        // nothing to move until the first escape has shifted the text
+        if (w != s) memmove(w, s, n);
+        w += n;
+    }
+
+    char* w;
+};
+
+// parse a string, *cur points at the opening quotation mark. Buffer needs push_back(char) and
+// append(const char*, size_t), the decoded characters are appended to it.
+template <typename Buffer>
+ParseResultType LitDecodeString(const char** cur, Buffer* buff) {
+    assert(*cur != nullptr && **cur == '\"');
+    unsigned uh = 0, ul = 0;
+    const char* p = *cur;
+    ++p;
+    while (true) {
+        // copy the plain run in one go, what stops the scan is handled below
+        const char* q = LitScanString(p);
+        if (q != p) {
+            buff->append(p, q - p);
+            p = q;
+        }
+        char ch = *p++;
+        switch (ch) {
+            case '\"': *cur = p; return LIT_PARSE_OK;
+            case '\\':
+                switch (*p++) {
+                    case '\"': buff->push_back('\"'); break;
+                    case '\\': buff->push_back('\\'); break;
+                    case '/': buff->push_back('/'); break;
+                    case 'b': buff->push_back('\b'); break;
+                    case 'f': buff->push_back('\f'); break;
+                    case 'n': buff->push_back('\n'); break;
+                    case 'r': buff->push_back('\r'); break;
+                    case 't': buff->push_back('\t'); break;
+                    case 'u':
+                        if (!(p = LitDecodeUnicode(p, &uh))) return LIT_PARSE_INVALID_UNICODE_HEX;
+                        if (uh >= 0xDC00 && uh <= 0xDFFF) return LIT_PARSE_INVALID_UNICODE_HEX;
+                        if (uh >= 0xD800 && uh <= 0xDBFF) {
+                            if (*p++ != '\\') return LIT_PARSE_INVALID_UNICODE_SURROGATE;
+                            if (*p++ != 'u') return LIT_PARSE_INVALID_UNICODE_SURROGATE;
+                            if (!(p = LitDecodeUnicode(p, &ul))) return LIT_PARSE_INVALID_UNICODE_HEX;
+                            if (ul < 0xDC00 || ul > 0xDFFF) return LIT_PARSE_INVALID_UNICODE_SURROGATE;
+                            uh = 0x10000 + (((uh - 0xD800) << 10) | (ul - 0xDC00));
+                        }
+                        LitEncodeUTF8(buff, uh);
+                        break;
+                    default: return LIT_PARSE_INVALID_STRING_ESCAPE;
+                }
+                break;
+            case '\0': return LIT_PARSE_MISS_QUOTATION_MARK;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) return LIT_PARSE_INVALID_STRING_CHAR;
+                buff->push_back(ch);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,306 @@
+#include "LitDocument.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "LitDecode.h"
+
+// parse
+void LitDocument::LitParseWhitespace() {
+    assert(cur != nullptr);
+    while (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r') ++cur;
+}
+
+ParseResultType LitDocument::LitParseLiteral(LitNode* v, const char* literal, LitType type) {
+    assert(cur != nullptr && cur[0] == literal[0]);
+    size_t i = 1;
+    for (; literal[i] != '\0'; ++i) {
+        if (cur[i] != literal[i]) return LIT_PARSE_INVALID_VALUE;
+    }
+
+    cur += i;
+
+    v->type = type;
+    return LIT_PARSE_OK;
+}
+
+ParseResultType LitDocument::LitParseNumber(LitNode* v) {
+    LitDecodedNumber num;
+    ParseResultType res;
+    if ((res = LitDecodeNumber(&cur, &num)) == LIT_PARSE_OK) {
+        // the union members line up, copy whichever one is set
+        v->u = num.u;
+        v->type = LIT_NUMBER;
+        v->num_type = num.type;
+    }
+    return res;
+}
+
+ParseResultType LitDocument::LitParseStringRaw(const char** str, size_t* len) {
+    ParseResultType res;
+    if (insitu) {
+        // only LitParseInsitu sets insitu, the text is writable
+        char* s = const_cast<char*>(cur) + 1;
+        LitInsituBuffer out(s);
+        if ((res = LitDecodeString(&cur, &out)) != LIT_PARSE_OK) return res;
+
+        // the terminator lands on the closing quotation mark at the latest, which has been consumed already
+        *out.w = '\0';
+        *str = s;
+        *len = out.w - s;
+        return LIT_PARSE_OK;
+    }
+
+    buff.clear();
+    if ((res = LitDecodeString(&cur, &buff)) != LIT_PARSE_OK) return res;
+
+    char* s = static_cast<char*>(arena.Allocate(buff.size() + 1));
+    memcpy(s, buff.data(), buff.size());
+    s[buff.size()] = '\0';
+    *str = s;
+    *len = buff.size();
+    return LIT_PARSE_OK;
+}
+
+ParseResultType LitDocument::LitParseString(LitNode* v) {
+    ParseResultType res;
+    if ((res = LitParseStringRaw(&v->str, &v->size)) == LIT_PARSE_OK) {
+        v->type = LIT_STRING;
+    }
+    return res;
+}
+
+ParseResultType LitDocument::LitParseArray(LitNode* v) {
+    assert(cur != nullptr && cur[0] == '[');
+    if (++depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+    ++cur;
+    LitParseWhitespace();
+    v->type = LIT_ARRAY;
+    v->arr = nullptr;
+    v->size = 0;
+    if (*cur == ']') {
+        ++cur;
+        --depth;
+        return LIT_PARSE_OK;
+    }
+
+    size_t top = node_stack.size();
+    ParseResultType res = LIT_PARSE_INVALID_VALUE;
+    while (true) {
+        // nested containers push onto node_stack too, so the element is parsed into a local and appended after
+        LitNode t;
+        if ((res = LitParseValue(&t)) != LIT_PARSE_OK) return res;
+
+        node_stack.push_back(t);
+        LitParseWhitespace();
+        if (*cur == ',') {
+            ++cur;
+            LitParseWhitespace();
+        } else if (*cur == ']') {
+            ++cur;
+            v->size = node_stack.size() - top;
+            LitNode* a = static_cast<LitNode*>(arena.Allocate(v->size * sizeof(LitNode)));
+            memcpy(a, &node_stack[top], v->size * sizeof(LitNode));
+            v->arr = a;
+            node_stack.resize(top);
+            --depth;
+            return LIT_PARSE_OK;
+        } else {
+            return LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        }
+    }
+}
+
+ParseResultType LitDocument::LitParseObject(LitNode* v) {
+    assert(cur != nullptr && cur[0] == '{');
+    if (++depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+    ++cur;
+    LitParseWhitespace();
+    v->type = LIT_OBJECT;
+    v->obj = nullptr;
+    v->size = 0;
+    if (*cur == '}') {
+        ++cur;
+        --depth;
+        return LIT_PARSE_OK;
+    }
+
+    size_t top = member_stack.size();
+    ParseResultType res = LIT_PARSE_INVALID_VALUE;
+    while (true) {
+        LitMember m;
+        if (*cur != '\"') return LIT_PARSE_MISS_KEY;
+        if ((res = LitParseStringRaw(&m.key, &m.key_len)) != LIT_PARSE_OK) return res;
+        LitParseWhitespace();
+        if (*cur != ':') return LIT_PARSE_MISS_COLON;
+        ++cur;
+        LitParseWhitespace();
+        if ((res = LitParseValue(&m.value)) != LIT_PARSE_OK) return res;
+        member_stack.push_back(m);
+        LitParseWhitespace();
+        if (*cur == ',') {
+            ++cur;
+            LitParseWhitespace();
+        } else if (*cur == '}') {
+            ++cur;
+            v->size = member_stack.size() - top;
+            LitMember* o = static_cast<LitMember*>(arena.Allocate(v->size * sizeof(LitMember)));
+            memcpy(o, &member_stack[top], v->size * sizeof(LitMember));
+            v->obj = o;
+            member_stack.resize(top);
+            --depth;
+            return LIT_PARSE_OK;
+        } else {
+            return LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        }
+    }
+}
+
+ParseResultType LitDocument::LitParseValue(LitNode* v) {
+    assert(cur != nullptr);
+    switch (*cur) {
+        case 'n': return LitParseLiteral(v, "null", LIT_NULL);
+        case 't': return LitParseLiteral(v, "true", LIT_TRUE);
+        case 'f': return LitParseLiteral(v, "false", LIT_FALSE);
+        case '\"': return LitParseString(v);
+        case '\0': return LIT_PARSE_EXPECT_VALUE;
+        case '[': return LitParseArray(v);
+        case '{': return LitParseObject(v);
+        default: return LitParseNumber(v);
+    }
+}
+
+ParseResultType LitDocument::LitParse(const char* json) {
+    insitu = false;
+    return LitParseRoot(json);
+}
+
+ParseResultType LitDocument::LitParseInsitu(char* json) {
+    insitu = true;
+    return LitParseRoot(json);
+}
+
+ParseResultType LitDocument::LitParseRoot(const char* json) {
+    assert(json != nullptr);
+    Reset();
+    cur = json;
+    depth = 0;
+    LitParseWhitespace();
+    ParseResultType res = LitParseValue(&root);
+    if (res == LIT_PARSE_OK) {
+        LitParseWhitespace();
+        if (*cur != '\0') res = LIT_PARSE_ROOT_NOT_SINGULAR;
+    }
+    if (res != LIT_PARSE_OK) Reset();
+    return res;
+}
+
+void LitDocument::Reset() {
+    arena.Reset();
+    node_stack.clear();
+    member_stack.clear();
+    root = LitNode();
+}
+
+void LitDocument::Release() {
+    Reset();
+    arena.Release();
+}
+
+// get
+LitType LitDocument::lit_get_type(const LitNode& v) const { return v.type; }
+
+bool LitDocument::lit_get_boolean(const LitNode& v) const {
+    assert(v.type == LIT_TRUE || v.type == LIT_FALSE);
+    return v.type == LIT_TRUE;
+}
+
+double LitDocument::lit_get_number(const LitNode& v) const {
+    assert(v.type == LIT_NUMBER);
+    switch (v.num_type) {
+        case LIT_NUMBER_INT64: return static_cast<double>(v.i);
+        case LIT_NUMBER_UINT64: return static_cast<double>(v.u);
+        default: return v.n;
+    }
+}
+LitNumberType LitDocument::lit_get_number_type(const LitNode& v) const {
+    assert(v.type == LIT_NUMBER);
+    return v.num_type;
+}
+int64_t LitDocument::lit_get_int64(const LitNode& v) const {
+    assert(v.type == LIT_NUMBER && v.num_type == LIT_NUMBER_INT64);
+    return v.i;
+}
+uint64_t LitDocument::lit_get_uint64(const LitNode& v) const {
+    assert(v.type == LIT_NUMBER && (v.num_type == LIT_NUMBER_UINT64 || (v.num_type == LIT_NUMBER_INT64 && v.i >= 0)));
+    return v.num_type == LIT_NUMBER_UINT64 ? v.u : static_cast<uint64_t>(v.i);
+}
+
+const char* LitDocument::lit_get_string(const LitNode& v) const {
+    assert(v.type == LIT_STRING);
+    return v.str;
+}
+size_t LitDocument::lit_get_string_length(const LitNode& v) const {
+    assert(v.type == LIT_STRING);
+    return v.size;
+}
+
+const LitNode& LitDocument::lit_get_array_element(const LitNode& v, size_t index) const {
+    assert(v.type == LIT_ARRAY && index < v.size);
+    return v.arr[index];
+}
+size_t LitDocument::lit_get_array_size(const LitNode& v) const {
+    assert(v.type == LIT_ARRAY);
+    return v.size;
+}
+
+size_t LitDocument::lit_get_object_size(const LitNode& v) const {
+    assert(v.type == LIT_OBJECT);
+    return v.size;
+}
+const char* LitDocument::lit_get_object_key(const LitNode& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.size);
+    return v.obj[index].key;
+}
+size_t LitDocument::lit_get_object_key_length(const LitNode& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.size);
+    return v.obj[index].key_len;
+}
+const LitNode& LitDocument::lit_get_object_value(const LitNode& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.size);
+    return v.obj[index].value;
+}
+
+void LitDocument::lit_to_value(const LitNode& v, LitValue* res) const {
+    assert(res != nullptr);
+    LitJson lit;
+    switch (v.type) {
+        case LIT_NULL: lit.lit_set_null(res); break;
+        case LIT_FALSE: lit.lit_set_boolean(res, false); break;
+        case LIT_TRUE: lit.lit_set_boolean(res, true); break;
+        case LIT_NUMBER:
+            switch (v.num_type) {
+                case LIT_NUMBER_DOUBLE: lit.lit_set_number(res, v.n); break;
+                case LIT_NUMBER_INT64: lit.lit_set_int64(res, v.i); break;
+                case LIT_NUMBER_UINT64: lit.lit_set_uint64(res, v.u); break;
+            }
+            break;
+        case LIT_STRING: lit.lit_set_string(res, v.str, v.size); break;
+        case LIT_ARRAY: {
+            LitValue::Array a(v.size, LitValue(), lit.lit_get_resource());
+            for (size_t i = 0; i < v.size; ++i) lit_to_value(v.arr[i], &a[i]);
+            lit.lit_set_array(res, std::move(a));
+            break;
+        }
+        case LIT_OBJECT: {
+            LitValue::Obj o(lit.lit_get_resource());
+            o.reserve(v.size);
+            for (size_t i = 0; i < v.size; ++i) {
+                o.emplace_back(LitValue::String(v.obj[i].key, v.obj[i].key_len, lit.lit_get_resource()), LitValue());
+                lit_to_value(v.obj[i].value, &o.back().second);
+            }
+            lit.lit_set_object(res, std::move(o));
+            break;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#ifndef LITDOCUMENT_H_
+#define LITDOCUMENT_H_
+
+#include <string>
+#include <vector>
+
+#include "LitArena.h"
+#include "LitJson.h"
+#include "LitValue.h"
+
+struct LitMember;
+
+// A parsed node inside a LitDocument. Nodes are trivially copyable and never own memory, everything they point
+// to lives in the arena of the document that produced them.
+class LitNode {
+    friend class LitDocument;
+
+public:
+    LitNode() : n(0.0), size(0), type(LIT_NULL), num_type(LIT_NUMBER_DOUBLE) {}
+
+private:
+    union {
+        double n;
+        int64_t i;
+        uint64_t u;
+        const char* str;
+        const LitNode* arr;
+        const LitMember* obj;
+    };
+    size_t size;  // string length, element count or member count
+    LitType type;
+    LitNumberType num_type;
+};
+
+struct LitMember {
+    const char* key;
+    size_t key_len;
+    LitNode value;
+};
+
+// Arena-backed read-only document. Every string, array and object of one parse is carved out of a single
+// LitArena, so dropping a document is O(1) and parsing into a reused document does not call malloc once the
+// arena and the scratch stacks have grown to the working size.
+class LitDocument {
+public:
+    explicit LitDocument(size_t chunk_size = LitArena::kDefaultChunkSize) : arena(chunk_size) {}
+    LitDocument(const LitDocument&) = delete;
+    LitDocument& operator=(const LitDocument&) = delete;
+
+    // Json Parse, the previous root and all nodes reached from it are invalidated
+    ParseResultType LitParse(const char* json);
+    // In-situ Json Parse: escapes are decoded inside json itself and strings and keys point into it instead of
+    // being copied, json is modified and must outlive the parsed tree
+    ParseResultType LitParseInsitu(char* json);
+    // drop the parsed tree and keep the memory for the next parse
+    void Reset();
+    // drop the parsed tree and give the memory back
+    void Release();
+    // arrays and objects nested deeper fail with LIT_PARSE_DEPTH_EXCEEDED, like in LitJson. That also bounds the
+    // recursion of lit_to_value.
+    size_t lit_get_max_depth() const { return max_depth; }
+    void lit_set_max_depth(size_t depth) { max_depth = depth; }
+
+    // getter function, const so a parsed document can be read from several threads
+    const LitNode& lit_get_root() const { return root; }
+    LitType lit_get_type(const LitNode& v) const;
+
+    bool lit_get_boolean(const LitNode& v) const;
+    // integers are converted, above 2^53 that may round
+    double lit_get_number(const LitNode& v) const;
+    LitNumberType lit_get_number_type(const LitNode& v) const;
+    int64_t lit_get_int64(const LitNode& v) const;
+    // also valid for non-negative int64 numbers
+    uint64_t lit_get_uint64(const LitNode& v) const;
+
+    // strings are NUL-terminated but may contain '\0', use the length
+    const char* lit_get_string(const LitNode& v) const;
+    size_t lit_get_string_length(const LitNode& v) const;
+
+    const LitNode& lit_get_array_element(const LitNode& v, size_t index) const;
+    size_t lit_get_array_size(const LitNode& v) const;
+
+    size_t lit_get_object_size(const LitNode& v) const;
+    const char* lit_get_object_key(const LitNode& v, size_t index) const;
+    size_t lit_get_object_key_length(const LitNode& v, size_t index) const;
+    const LitNode& lit_get_object_value(const LitNode& v, size_t index) const;
+
+    // deep copy a node into a heap allocated LitValue that outlives the document
+    void lit_to_value(const LitNode& v, LitValue* res) const;
+
+    size_t lit_get_arena_capacity() const { return arena.Capacity(); }
+
+private:
+    // parse
+    ParseResultType LitParseRoot(const char* json);
+    void LitParseWhitespace();
+    ParseResultType LitParseLiteral(LitNode* v, const char* literal, LitType type);
+    ParseResultType LitParseValue(LitNode* v);
+    ParseResultType LitParseNumber(LitNode* v);
+    ParseResultType LitParseStringRaw(const char** str, size_t* len);
+    ParseResultType LitParseString(LitNode* v);
+    ParseResultType LitParseArray(LitNode* v);
+    ParseResultType LitParseObject(LitNode* v);
+
+    LitArena arena;
+    LitNode root;
+
+    // scratch space reused across parses: children are collected here until their container is closed and then
+    // copied into the arena in one piece
+    std::vector<LitNode> node_stack;
+    std::vector<LitMember> member_stack;
+    std::string buff;
+
+    const char* cur = nullptr;
+    bool insitu = false;
+    size_t depth = 0;  // containers the parser is inside of
+    size_t max_depth = LitJson::kDefaultMaxDepth;
+};
+
+#endif
@@ -1,381 +1,734 @@
 #include "litjson.h"
 
+#include <algorithm>
 #include <cassert>
-#include <cctype>
-#include <cerrno>
 #include <cmath>
-#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+#include "LitDecode.h"
+#include "LitMappedFile.h"
+#include "LitNumber.h"
+#include "LitObjectIndex.h"
+#include "LitShapeCache.h"
+#include "LitSink.h"
+#include "LitStructural.h"
+
 // parse
-void LitJson::LitParseWhitespace() {
-    assert(cur != nullptr);
-    while (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r') ++cur;
+void LitJson::LitParseWhitespace(LitParseContext* c) {
+    // the text ends in a non-whitespace character, so once inside no loop below can run past end
+    if (c->cur == c->end) return;
+    if (c->next_structural != nullptr) {
+        // the first non-whitespace character after whitespace is always in the index
+        if (LitIsWhitespace(*c->cur)) {
+            uint32_t pos = static_cast<uint32_t>(c->cur - c->begin);
+            while (*c->next_structural < pos) ++c->next_structural;
+            c->cur = c->begin + *c->next_structural;
+        }
+        return;
+    }
+    while (LitIsWhitespace(*c->cur)) ++c->cur;
 }
 
-ParseResultType LitJson::LitParseNull(LitValue* v) {
-    assert(cur != nullptr && cur[0] == 'n');
-    if (cur[1] != 'u' || cur[2] != 'l' || cur[3] != 'l') {
+ParseResultType LitJson::LitParseNull(LitParseContext* c, LitValue* v) const {
+    assert(c->cur != nullptr && c->cur[0] == 'n');
+    if (c->end - c->cur < 4 || c->cur[1] != 'u' || c->cur[2] != 'l' || c->cur[3] != 'l') {
         return LIT_PARSE_INVALID_VALUE;
     }
 
-    cur += 4;
+    c->cur += 4;
 
     lit_set_null(v);
+    LIT_STATS_ONLY(++c->stats.values[LIT_NULL]);
     return LIT_PARSE_OK;
 }
 
-ParseResultType LitJson::LitParseTrue(LitValue* v) {
-    assert(cur != nullptr && cur[0] == 't');
-    if (cur[1] != 'r' || cur[2] != 'u' || cur[3] != 'e') {
+ParseResultType LitJson::LitParseTrue(LitParseContext* c, LitValue* v) const {
+    assert(c->cur != nullptr && c->cur[0] == 't');
+    if (c->end - c->cur < 4 || c->cur[1] != 'r' || c->cur[2] != 'u' || c->cur[3] != 'e') {
         return LIT_PARSE_INVALID_VALUE;
     }
 
-    cur += 4;
+    c->cur += 4;
 
     lit_set_boolean(v, true);
+    LIT_STATS_ONLY(++c->stats.values[LIT_TRUE]);
     return LIT_PARSE_OK;
 }
 
-ParseResultType LitJson::LitParseFalse(LitValue* v) {
-    assert(cur != nullptr && cur[0] == 'f');
-    if (cur[1] != 'a' || cur[2] != 'l' || cur[3] != 's' || cur[4] != 'e') {
+ParseResultType LitJson::LitParseFalse(LitParseContext* c, LitValue* v) const {
+    assert(c->cur != nullptr && c->cur[0] == 'f');
+    if (c->end - c->cur < 5 || c->cur[1] != 'a' || c->cur[2] != 'l' || c->cur[3] != 's' || c->cur[4] != 'e') {
         return LIT_PARSE_INVALID_VALUE;
     }
 
-    cur += 5;
+    c->cur += 5;
 
     lit_set_boolean(v, false);
+    LIT_STATS_ONLY(++c->stats.values[LIT_FALSE]);
     return LIT_PARSE_OK;
 }
 
-ParseResultType LitJson::LitParseNumber(LitValue* v) {
-    const char* p = cur;
-
-    // skip '-'
-    if (*p == '-') ++p;
-
-    // parse number
-    if (*p == '0') {
-        ++p;
+ParseResultType LitJson::LitParseNumber(LitParseContext* c, LitValue* v) const {
+    LIT_STATS_ONLY(LitStatsTimer timer(&c->stats.number_ns));
+    LitDecodedNumber num;
+    ParseResultType res;
+    if (c->number_at_end) {
+        // a number running into the end of the text is decoded from a terminated copy
+        const char* q = c->cur;
+        while (q < c->end && LitIsNumberChar(*q)) ++q;
+        if (q == c->end) {
+            c->tail.assign(c->cur, c->end);
+            const char* t = c->tail.c_str();
+            res = LitDecodeNumber(&t, &num);
+            c->cur += t - c->tail.c_str();
+        } else {
+            res = LitDecodeNumber(&c->cur, &num);
+        }
     } else {
-        if (!isdigit(*p)) return LIT_PARSE_INVALID_VALUE;
-        while (isdigit(*p)) ++p;
+        res = LitDecodeNumber(&c->cur, &num);
     }
-
-    // parse '.'
-    if (*p == '.') {
-        ++p;
-        if (!isdigit(*p)) return LIT_PARSE_INVALID_VALUE;
-        while (isdigit(*p)) ++p;
-    }
-
-    // parse 'e' or 'E'
-    if (*p == 'e' || *p == 'E') {
-        ++p;
-        if (*p == '-' || *p == '+') ++p;
-        if (!isdigit(*p)) return LIT_PARSE_INVALID_VALUE;
-        while (isdigit(*p)) ++p;
-    }
-
-    // check range error
-    errno = 0;
-
-    lit_set_number(v, strtod(cur, nullptr));
-    if (errno == ERANGE && (v->n == HUGE_VAL || v->n == -HUGE_VAL)) {
-        v->type = LIT_NULL;
-        return LIT_PARSE_NUMBER_TOO_BIG;
+    if (res == LIT_PARSE_OK) {
+        switch (num.type) {
+            case LIT_NUMBER_DOUBLE: lit_set_number(v, num.d); break;
+            case LIT_NUMBER_INT64: lit_set_int64(v, num.i); break;
+            case LIT_NUMBER_UINT64: lit_set_uint64(v, num.u); break;
+        }
+        LIT_STATS_ONLY(++c->stats.values[LIT_NUMBER]);
     }
-
-    cur = p;
-    return LIT_PARSE_OK;
-}
-
-ParseResultType DealStringError(ParseResultType t, std::string* buff) {
-    buff->clear();
-    return t;
+    return res;
 }
 
-ParseResultType LitJson::LitParseString(LitValue* v) {
+ParseResultType LitJson::LitParseString(LitParseContext* c, LitValue* v) const {
     ParseResultType res;
-    std::string buff;
-    if ((res = LitParseStringRaw(&buff)) == LIT_PARSE_OK) {
-        lit_set_string(v, buff);
+    LitValue::String buff(resource);
+    if ((res = LitParseStringRaw(c, &buff)) == LIT_PARSE_OK) {
+        LitSetString(v, std::move(buff));
+        LIT_STATS_ONLY(++c->stats.values[LIT_STRING]);
     }
     return res;
 }
 
-ParseResultType LitJson::LitParseStringRaw(std::string* buff) {
-    assert(cur != nullptr && cur[0] == '\"');
-    unsigned uh = 0, ul = 0;
-    const char* p = cur;
-    ++p;
-    while (true) {
-        char ch = *p++;
-        switch (ch) {
-            case '\"': cur = p; return LIT_PARSE_OK;
-            case '\\':
-                switch (*p++) {
-                    case '\"': buff->push_back('\"'); break;
-                    case '\\': buff->push_back('\\'); break;
-                    case '/': buff->push_back('/'); break;
-                    case 'b': buff->push_back('\b'); break;
-                    case 'f': buff->push_back('\f'); break;
-                    case 'n': buff->push_back('\n'); break;
-                    case 'r': buff->push_back('\r'); break;
-                    case 't': buff->push_back('\t'); break;
-                    case 'u':
-                        if (!(p = LitParseUnicode(p, &uh))) return DealStringError(LIT_PARSE_INVALID_UNICODE_HEX, buff);
-                        if (uh >= 0xDC00 && uh <= 0xDFFF) return DealStringError(LIT_PARSE_INVALID_UNICODE_HEX, buff);
-                        if (uh >= 0xD800 && uh <= 0xDBFF) {
-                            if (*p++ != '\\') return DealStringError(LIT_PARSE_INVALID_UNICODE_SURROGATE, buff);
-                            if (*p++ != 'u') return DealStringError(LIT_PARSE_INVALID_UNICODE_SURROGATE, buff);
-                            if (!(p = LitParseUnicode(p, &ul)))
-                                return DealStringError(LIT_PARSE_INVALID_UNICODE_HEX, buff);
-                            if (ul < 0xDC00 || ul > 0xDFFF)
-                                return DealStringError(LIT_PARSE_INVALID_UNICODE_SURROGATE, buff);
-                            uh = 0x10000 + (((uh - 0xD800) << 10) | (ul - 0xDC00));
-                        }
-                        LitEncodeUTF8(buff, uh);
-                        break;
-                    default: return LIT_PARSE_INVALID_STRING_ESCAPE;
-                }
-                break;
-            case '\0': return DealStringError(LIT_PARSE_MISS_QUOTATION_MARK, buff);
-            default:
-                if (static_cast<unsigned char>(ch) < 0x20) return DealStringError(LIT_PARSE_INVALID_STRING_CHAR, buff);
-                buff->push_back(ch);
-        }
+ParseResultType LitJson::LitParseStringRaw(LitParseContext* c, LitValue::String* buff) const {
+    LIT_STATS_ONLY(LitStatsTimer timer(&c->stats.string_ns));
+    LIT_STATS_ONLY(const char* start = c->cur);
+    ParseResultType res;
+    if (c->cur < LitLastQuote(c)) {
+        // the decoder stops at the closing quote at the latest
+        res = LitDecodeString(&c->cur, buff);
+    } else {
+        // no closing quote left, decode a terminated copy to report the same error as at a '\0'
+        c->tail.assign(c->cur, c->end);
+        const char* t = c->tail.c_str();
+        res = LitDecodeString(&t, buff);
+        c->cur += t - c->tail.c_str();
     }
+    if (res != LIT_PARSE_OK) {
+        buff->clear();
+        return res;
+    }
+#ifdef LIT_ENABLE_STATS
+    // every escape is longer than what it decodes to
+    ++(static_cast<size_t>(c->cur - start) - 2 == buff->size() ? c->stats.strings_plain : c->stats.strings_escaped);
+    c->LitCountString(*buff);
+#endif
+    return res;
 }
 
-const char* LitJson::LitParseUnicode(const char* p, unsigned int* u) {
-    *u = 0;
-    for (int i = 0; i < 4; ++i) {
-        char ch = *p++;
-        *u <<= 4;
-        if (ch >= '0' && ch <= '9') {
-            *u |= ch - '0';
-        } else if (ch >= 'A' && ch <= 'F') {
-            *u |= ch - 'A' + 10;
-        } else if (ch >= 'a' && ch <= 'f') {
-            *u |= ch - 'a' + 10;
-        } else {
-            return nullptr;
+const char* LitJson::LitLastQuote(LitParseContext* c) {
+    if (c->last_quote != nullptr) return c->last_quote;
+    // the last quote not escaped by an odd run of backslashes. A string that starts before it ends at it or
+    // earlier: the decoder pairs up backslashes the same way, and a \u escape never swallows a quote.
+    c->last_quote = c->begin;
+    for (const char* p = c->end; p > c->begin;) {
+        if (*--p != '\"') continue;
+        size_t run = 0;
+        while (p - run > c->begin && p[-1 - static_cast<ptrdiff_t>(run)] == '\\') ++run;
+        if (run % 2 == 0) {
+            c->last_quote = p;
+            break;
         }
+        p -= run;
     }
-    return p;
-}
-
-void LitJson::LitEncodeUTF8(std::string* buff, unsigned int u) {
-    if (u <= 0x7F) {
-        buff->push_back(u);
-    } else if (u <= 0x7FF) {
-        buff->push_back(0xC0 | ((u >> 6) & 0xFF));
-        buff->push_back(0x80 | (u & 0x3F));
-    } else if (u <= 0xFFFF) {
-        buff->push_back(0xE0 | ((u >> 12) & 0xFF));
-        buff->push_back(0x80 | ((u >> 6) & 0x3F));
-        buff->push_back(0x80 | (u & 0x3F));
+    return c->last_quote;
+}
+
+ParseResultType LitJson::LitParseMember(LitParseContext* c, LitParseFrame* f) const {
+    LitValue::Obj& aux = f->members;
+    LitShapeCache* cache = c->shapes;
+    if (c->LitPeek() != '\"') return LIT_PARSE_MISS_KEY;
+    uint32_t next = LitShapeCache::kNone;
+    if (cache != nullptr) next = cache->LitMatch(cache->LitPredict(f->outer, f->shape), c->cur, c->end);
+    if (next != LitShapeCache::kNone) {
+        // the key the last object had here, copied from the cache instead of decoded
+        const std::string& key = cache->lit_get_key(next);
+        c->cur += key.size() + 2;
+        if (f->shape == LitShapeCache::kEmpty) aux.reserve(cache->shapes[next].members);
+        aux.emplace_back(LitValue::String(key.data(), key.size(), resource), LitValue());
+        LIT_STATS_ONLY(++c->stats.strings_plain);
+        LIT_STATS_ONLY(c->LitCountString(aux.back().first));
     } else {
-        assert(u <= 0x10FFFF);
-        buff->push_back(0xF0 | ((u >> 18) & 0xFF));
-        buff->push_back(0x80 | ((u >> 12) & 0x3F));
-        buff->push_back(0x80 | ((u >> 6) & 0x3F));
-        buff->push_back(0x80 | (u & 0x3F));
+        aux.emplace_back(LitValue::String(resource), LitValue());
+        const LitValue::String& key = aux.back().first;
+        ParseResultType res = LitParseStringRaw(c, &aux.back().first);
+        if (res != LIT_PARSE_OK) return res;
+        if (cache != nullptr) next = cache->LitAdd(f->outer, f->shape, key.data(), key.size());
     }
+    LIT_STATS_ONLY(c->LitCountBuffer(aux.capacity() * sizeof(aux[0]), &f->capacity));
+    if (f->shape == LitShapeCache::kEmpty) f->first = next;
+    f->shape = next;
+    c->member_shape = next;
+    LitParseWhitespace(c);
+    if (c->LitPeek() != ':') return LIT_PARSE_MISS_COLON;
+    ++c->cur;
+    LitParseWhitespace(c);
+    return LIT_PARSE_OK;
 }
 
-ParseResultType LitJson::LitParseArray(LitValue* v) {
-    assert(cur != nullptr && cur[0] == '[');
-    ++cur;
-    LitParseWhitespace();
-    if (*cur == ']') {
-        ++cur;
-        lit_set_array(v, {});
-        return LIT_PARSE_OK;
-    }
-
-    std::vector<LitValue> aux;
-    ParseResultType res = LIT_PARSE_INVALID_VALUE;
-    while (true) {
-        LitValue t;
-        if ((res = LitParseValue(&t)) != LIT_PARSE_OK) return res;
-
-        aux.push_back(t);
-        LitParseWhitespace();
-        if (*cur == ',') {
-            ++cur;
-            LitParseWhitespace();
-        } else if (*cur == ']') {
-            ++cur;
-            lit_set_array(v, aux);
-            return LIT_PARSE_OK;
-        } else {
-            return LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+void LitJson::LitCloseFrame(LitParseContext* c, LitParseFrame* f, LitValue* v) const {
+    if (!f->object) {
+        LitSetArray(v, std::move(f->elements));
+    } else {
+        if (f->first != LitShapeCache::kNone) {
+            c->shapes->shapes[f->first].members = static_cast<uint32_t>(f->members.size());
         }
+        c->member_shape = f->outer;
+        LitSetObject(v, std::move(f->members));
     }
+    LIT_STATS_ONLY(--c->depth);
 }
 
-ParseResultType LitJson::LitParseObject(LitValue* v) {
-    assert(cur != nullptr && cur[0] == '{');
-    ++cur;
-    LitParseWhitespace();
-    if (*cur == '}') {
-        ++cur;
-        lit_set_object(v, {});
-        return LIT_PARSE_OK;
-    }
-
-    LitValue::Obj aux;
-    ParseResultType res = LIT_PARSE_INVALID_VALUE;
+// Arrays and objects don't recurse: an open one is a frame on c->stack and values are parsed in place into its
+// last element or member. After each value the loop closes every container whose end follows.
+ParseResultType LitJson::LitParseValue(LitParseContext* c, LitValue* v) const {
+    std::vector<LitParseFrame>& stack = *c->stack;
+    LitValue* target = v;
+    ParseResultType res;
     while (true) {
-        std::string key;
-        LitValue value;
-        if (*cur != '\"') return LIT_PARSE_MISS_KEY;
-        if ((res = LitParseStringRaw(&key)) != LIT_PARSE_OK) return res;
-        LitParseWhitespace();
-        if (*cur != ':') return LIT_PARSE_MISS_COLON;
-        ++cur;
-        LitParseWhitespace();
-        if ((res = LitParseValue(&value)) != LIT_PARSE_OK) return res;
-        aux.push_back({key, value});
-        LitParseWhitespace();
-        if (*cur == ',') {
-            ++cur;
-            LitParseWhitespace();
-        } else if (*cur == '}') {
-            ++cur;
-            lit_set_object(v, aux);
-            return LIT_PARSE_OK;
-        } else {
-            return LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        char ch = c->LitPeek();
+        switch (ch) {
+            case 'n': res = LitParseNull(c, target); break;
+            case 't': res = LitParseTrue(c, target); break;
+            case 'f': res = LitParseFalse(c, target); break;
+            case '\"': res = LitParseString(c, target); break;
+            case '\0': return LIT_PARSE_EXPECT_VALUE;
+            case '[':
+            case '{': {
+                if (stack.size() >= max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+                bool object = ch == '{';
+                ++c->cur;
+                LIT_STATS_ONLY(c->stats.max_depth = std::max(c->stats.max_depth, ++c->depth));
+                LIT_STATS_ONLY(++c->stats.values[object ? LIT_OBJECT : LIT_ARRAY]);
+                stack.emplace_back(object, resource);
+                LitParseFrame& f = stack.back();
+                f.outer = c->member_shape;
+                f.shape = LitShapeCache::kEmpty;
+                f.first = LitShapeCache::kNone;
+                LitParseWhitespace(c);
+                if (c->LitPeek() == (object ? '}' : ']')) {
+                    ++c->cur;
+                    LitCloseFrame(c, &f, target);
+                    stack.pop_back();
+                    res = LIT_PARSE_OK;
+                    break;
+                }
+                if (object) {
+                    if ((res = LitParseMember(c, &f)) != LIT_PARSE_OK) return res;
+                    target = &f.members.back().second;
+                } else {
+                    // LitValue is nothrow movable, growing elements never copies subtrees
+                    f.elements.emplace_back();
+                    LIT_STATS_ONLY(c->LitCountBuffer(f.elements.capacity() * sizeof(LitValue), &f.capacity));
+                    target = &f.elements.back();
+                }
+                continue;
+            }
+            default: res = LitParseNumber(c, target); break;
+        }
+        if (res != LIT_PARSE_OK) return res;
+
+        // a value is complete, close what ends after it until a comma opens the next slot
+        while (!stack.empty()) {
+            LitParseFrame& f = stack.back();
+            LitParseWhitespace(c);
+            ch = c->LitPeek();
+            if (ch == ',') {
+                ++c->cur;
+                LitParseWhitespace(c);
+                if (f.object) {
+                    if ((res = LitParseMember(c, &f)) != LIT_PARSE_OK) return res;
+                    target = &f.members.back().second;
+                } else {
+                    f.elements.emplace_back();
+                    LIT_STATS_ONLY(c->LitCountBuffer(f.elements.capacity() * sizeof(LitValue), &f.capacity));
+                    target = &f.elements.back();
+                }
+                break;
+            }
+            if (ch != (f.object ? '}' : ']')) {
+                return f.object ? LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+            ++c->cur;
+            LitValue* slot = v;
+            if (stack.size() > 1) {
+                LitParseFrame& parent = stack[stack.size() - 2];
+                slot = parent.object ? &parent.members.back().second : &parent.elements.back();
+            }
+            LitCloseFrame(c, &f, slot);
+            stack.pop_back();
         }
+        if (stack.empty()) return LIT_PARSE_OK;
     }
 }
 
-ParseResultType LitJson::LitParseValue(LitValue* v) {
-    assert(cur != nullptr);
-    switch (*cur) {
-        case 'n': return LitParseNull(v);
-        case 't': return LitParseTrue(v);
-        case 'f': return LitParseFalse(v);
-        case '\"': return LitParseString(v);
-        case '\0': return LIT_PARSE_EXPECT_VALUE;
-        case '[': return LitParseArray(v);
-        case '{': return LitParseObject(v);
-        default: return LitParseNumber(v);
-    }
+ParseResultType LitJson::LitParse(LitValue* v, const char* json) const {
+    assert(json != nullptr);
+    return LitParse(v, json, strlen(json));
 }
 
-ParseResultType LitJson::LitParse(LitValue* v, const char* json) {
-    assert(v != nullptr);
-    cur = json;
-    LitParseWhitespace();
-    ParseResultType res = LitParseValue(v);
+ParseResultType LitJson::LitParse(LitValue* v, const char* json, size_t len) const {
+    return LitParse(v, json, len, nullptr);
+}
+
+// the index only pays off when most bytes are whitespace, as in indented text. Count it in a few windows spread
+// over the text rather than reading all of it twice
+static bool LitIsWhitespaceDense(const char* json, size_t len) {
+    const size_t kWindows = 8, kWindow = 512;
+    size_t ws = 0;
+    for (size_t i = 0; i < kWindows; ++i) {
+        const char* p = json + (len - kWindow) / (kWindows - 1) * i;
+        for (size_t j = 0; j < kWindow; ++j) ws += LitIsWhitespace(p[j]);
+    }
+    // at half the bytes or more, measured on a corpus indented by 2 and more
+    return ws * 2 >= kWindows * kWindow;
+}
+
+ParseResultType LitJson::LitParse(LitValue* v, const char* json, size_t len, LitShapeCache* cache) const {
+    assert(v != nullptr && (json != nullptr || len == 0));
+    LIT_STATS_ONLY(LitStats stats);
+    LIT_STATS_ONLY(stats.bytes_scanned = len);
+    // trailing whitespace can go, then no token and no whitespace run reaches end unless the text itself is cut
+    // off inside a number or a string, the only two cases that need a terminated copy
+    while (len > 0 && LitIsWhitespace(json[len - 1])) --len;
+    LitParseContext c;
+    c.cur = c.begin = json;
+    c.end = json + len;
+    c.number_at_end = len > 0 && LitIsNumberChar(c.end[-1]);
+    c.shapes = cache;
+
+    // one index per thread, reused by every parse on that thread
+    static thread_local std::vector<uint32_t> structural;
+    if (len >= kStructuralIndexThreshold && len < 0xFFFFFFFFu && LitIsWhitespaceDense(json, len)) {
+        LitBuildStructuralIndex(json, len, &structural);
+        c.next_structural = structural.data();
+    }
+    // one stack per thread like the index, it keeps its capacity between parses
+    static thread_local std::vector<LitParseFrame> stack;
+    c.stack = &stack;
+    LitParseWhitespace(&c);
+    ParseResultType res = LitParseValue(&c, v);
+    // the containers left open by an error
+    stack.clear();
     if (res == LIT_PARSE_OK) {
-        LitParseWhitespace();
-        if (*cur != '\0') {
-            v->type = LIT_NULL;
+        LitParseWhitespace(&c);
+        if (c.cur != c.end) {
+            lit_set_null(v);
             res = LIT_PARSE_ROOT_NOT_SINGULAR;
         }
     } else {
-        v->type = LIT_NULL;
+        lit_set_null(v);
     }
+    // one huge text must not pin 4 bytes per input byte on a long-lived thread
+    if (structural.capacity() > kStructuralIndexRetained) std::vector<uint32_t>().swap(structural);
+#ifdef LIT_ENABLE_STATS
+    c.stats.parses = 1;
+    c.stats.bytes_scanned = stats.bytes_scanned;
+    LitReportStats(c.stats);
+#endif
     return res;
 }
 
+ParseResultType LitJson::LitParseFile(LitValue* v, const char* path) const {
+    assert(v != nullptr && path != nullptr);
+    LitMappedFile file;
+    if (!file.Open(path)) {
+        lit_set_null(v);
+        return LIT_PARSE_FILE_ERROR;
+    }
+    return LitParse(v, file.data(), file.size());
+}
+
 // set and get
-LitType LitJson::lit_get_type(const LitValue& v) { return v.type; }
+LitType LitJson::lit_get_type(const LitValue& v) const { return v.type; }
 
-void LitJson::lit_set_null(LitValue* v) {
+void LitJson::lit_set_null(LitValue* v) const {
     assert(v != nullptr);
-    if (v->type == LIT_STRING) v->str.~basic_string();
-    if (v->type == LIT_ARRAY) v->arr.~vector<LitValue>();
+    v->UnionFree();
     v->type = LIT_NULL;
 }
 
-bool LitJson::lit_get_boolean(const LitValue& v) {
+bool LitJson::lit_get_boolean(const LitValue& v) const {
     assert(v.type == LIT_TRUE || v.type == LIT_FALSE);
     return v.type;
 }
-void LitJson::lit_set_boolean(LitValue* v, bool b) {
+void LitJson::lit_set_boolean(LitValue* v, bool b) const {
     assert(v != nullptr);
     *v = b;
 }
 
-double LitJson::lit_get_number(const LitValue& v) {
+double LitJson::lit_get_number(const LitValue& v) const {
     assert(v.type == LIT_NUMBER);
-    return v.n;
+    switch (v.num_type) {
+        case LIT_NUMBER_INT64: return static_cast<double>(v.i);
+        case LIT_NUMBER_UINT64: return static_cast<double>(v.u);
+        default: return v.n;
+    }
 }
-void LitJson::lit_set_number(LitValue* v, double n) {
-    assert(v != nullptr);
+void LitJson::lit_set_number(LitValue* v, double n) const {
+    assert(v != nullptr && std::isfinite(n));
     *v = n;
 }
 
-std::string LitJson::lit_get_string(const LitValue& v) {
+LitNumberType LitJson::lit_get_number_type(const LitValue& v) const {
+    assert(v.type == LIT_NUMBER);
+    return v.num_type;
+}
+
+int64_t LitJson::lit_get_int64(const LitValue& v) const {
+    assert(v.type == LIT_NUMBER && v.num_type == LIT_NUMBER_INT64);
+    return v.i;
+}
+void LitJson::lit_set_int64(LitValue* v, int64_t i) const {
+    assert(v != nullptr);
+    *v = i;
+}
+
+uint64_t LitJson::lit_get_uint64(const LitValue& v) const {
+    assert(v.type == LIT_NUMBER && (v.num_type == LIT_NUMBER_UINT64 || (v.num_type == LIT_NUMBER_INT64 && v.i >= 0)));
+    return v.num_type == LIT_NUMBER_UINT64 ? v.u : static_cast<uint64_t>(v.i);
+}
+void LitJson::lit_set_uint64(LitValue* v, uint64_t u) const {
+    assert(v != nullptr);
+    *v = u;
+}
+
+const LitValue::String& LitJson::lit_get_string(const LitValue& v) const {
     assert(v.type == LIT_STRING);
     return v.str;
 }
-void LitJson::lit_set_string(LitValue* v, const std::string& s) {
+void LitJson::lit_set_string(LitValue* v, const std::string& s) const { lit_set_string(v, s.data(), s.size()); }
+void LitJson::lit_set_string(LitValue* v, const char* s) const { lit_set_string(v, s, strlen(s)); }
+void LitJson::lit_set_string(LitValue* v, const char* s, size_t len) const {
+    assert(v != nullptr && (s != nullptr || len == 0));
+    // copied before v is freed, s may point into v
+    LitSetString(v, LitValue::String(s, len, resource));
+}
+void LitJson::lit_set_string(LitValue* v, LitValue::String&& s) const {
     assert(v != nullptr);
-    *v = s;
+    if (s.get_allocator() == LitValue::String::allocator_type(resource)) {
+        LitSetString(v, std::move(s));
+        return;
+    }
+    lit_set_string(v, s.data(), s.size());
+}
+void LitJson::LitSetString(LitValue* v, LitValue::String&& s) const {
+    // taken out first, s may live inside v
+    LitValue::String taken(std::move(s));
+    v->UnionFree();
+    new (&v->str) LitValue::String(std::move(taken));
+    v->type = LIT_STRING;
 }
 
-LitValue& LitJson::lit_get_array_element(LitValue& v, size_t index) {
+LitValue& LitJson::lit_get_array_element(LitValue& v, size_t index) const {
     assert(v.type == LIT_ARRAY && index < v.arr.size());
     return v.arr[index];
 }
-const LitValue& LitJson::lit_get_array_element(const LitValue& v, size_t index) {
+const LitValue& LitJson::lit_get_array_element(const LitValue& v, size_t index) const {
     assert(v.type == LIT_ARRAY && index < v.arr.size());
     return v.arr[index];
 }
 
-size_t LitJson::lit_get_array_size(const LitValue& v) {
+size_t LitJson::lit_get_array_size(const LitValue& v) const {
     assert(v.type == LIT_ARRAY);
     return v.arr.size();
 }
-void LitJson::lit_set_array(LitValue* v, const std::vector<LitValue>& a) {
+void LitJson::lit_set_array(LitValue* v, const LitValue::Array& a) const {
+    assert(v != nullptr);
+    LitValue::Array copy(resource);
+    copy.reserve(a.size());
+    for (const LitValue& e : a) {
+        copy.emplace_back();
+        LitCopy(&copy.back(), e);
+    }
+    LitSetArray(v, std::move(copy));
+}
+void LitJson::lit_set_array(LitValue* v, LitValue::Array&& a) const {
     assert(v != nullptr);
-    *v = a;
+    if (a.get_allocator() == LitValue::Array::allocator_type(resource)) {
+        LitSetArray(v, std::move(a));
+        return;
+    }
+    // a buffer of another resource, the elements move into one of ours
+    LitValue::Array moved(resource);
+    moved.reserve(a.size());
+    for (LitValue& e : a) moved.push_back(std::move(e));
+    LitSetArray(v, std::move(moved));
+}
+void LitJson::LitSetArray(LitValue* v, LitValue::Array&& a) const {
+    LitValue::Array taken(std::move(a));
+    v->UnionFree();
+    new (&v->arr) LitValue::Array(std::move(taken));
+    v->type = LIT_ARRAY;
 }
 
-size_t LitJson::lit_get_object_size(const LitValue& v) {
+size_t LitJson::lit_get_object_size(const LitValue& v) const {
     assert(v.type == LIT_OBJECT);
-    return v.obj.size();
+    return v.obj.members.size();
+}
+const LitValue::String& LitJson::lit_get_object_key(const LitValue& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.obj.members.size());
+    return v.obj.members[index].first;
+}
+size_t LitJson::lit_get_object_key_length(const LitValue& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.obj.members.size());
+    return v.obj.members[index].first.size();
+}
+LitValue& LitJson::lit_get_object_value(LitValue& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.obj.members.size());
+    return v.obj.members[index].second;
+}
+const LitValue& LitJson::lit_get_object_value(const LitValue& v, size_t index) const {
+    assert(v.type == LIT_OBJECT && index < v.obj.members.size());
+    return v.obj.members[index].second;
+}
+size_t LitJson::lit_find_object_index(const LitValue& v, const char* key, size_t klen) const {
+    assert(v.type == LIT_OBJECT && key != nullptr);
+    const LitValue::Obj& members = v.obj.members;
+    if (members.size() >= LitObjectIndex::kThreshold) {
+        LitObjectIndex* index = v.obj.index.load(std::memory_order_acquire);
+        if (index == nullptr) {
+            // threads looking up the same object may race to build it, the first index published wins. That is also
+            // why it comes from new and not from the object's resource, see LitMemory.h
+            LitObjectIndex* built = new LitObjectIndex(members);
+            if (v.obj.index.compare_exchange_strong(index, built, std::memory_order_acq_rel)) {
+                index = built;
+            } else {
+                delete built;
+            }
+        }
+        return index->Find(members, key, klen);
+    }
+    for (size_t i = 0; i < members.size(); ++i) {
+        const LitValue::String& k = members[i].first;
+        if (k.size() == klen && memcmp(k.data(), key, klen) == 0) return i;
+    }
+    return LIT_KEY_NOT_EXIST;
 }
-const std::string& LitJson::lit_get_object_key(const LitValue& v, size_t index) {
-    assert(v.type == LIT_OBJECT && index < v.obj.size());
-    return v.obj[index].first;
+LitValue* LitJson::lit_find_object_value(LitValue& v, const char* key, size_t klen) const {
+    size_t index = lit_find_object_index(v, key, klen);
+    return index == LIT_KEY_NOT_EXIST ? nullptr : &v.obj.members[index].second;
 }
-size_t LitJson::lit_get_object_key_length(const LitValue& v, size_t index) {
-    assert(v.type == LIT_OBJECT && index < v.obj.size());
-    return v.obj[index].first.size();
+const LitValue* LitJson::lit_find_object_value(const LitValue& v, const char* key, size_t klen) const {
+    size_t index = lit_find_object_index(v, key, klen);
+    return index == LIT_KEY_NOT_EXIST ? nullptr : &v.obj.members[index].second;
 }
-LitValue& LitJson::lit_get_object_value(LitValue& v, size_t index) {
-    assert(v.type == LIT_OBJECT && index < v.obj.size());
-    return v.obj[index].second;
+void LitJson::lit_set_object(LitValue* v, const LitValue::Obj& obj) const {
+    assert(v != nullptr);
+    LitValue::Obj copy(resource);
+    copy.reserve(obj.size());
+    for (const auto& m : obj) {
+        copy.emplace_back(LitValue::String(m.first.data(), m.first.size(), resource), LitValue());
+        LitCopy(&copy.back().second, m.second);
+    }
+    LitSetObject(v, std::move(copy));
 }
-void LitJson::lit_set_object(LitValue* v, const LitValue::Obj& obj) {
+void LitJson::lit_set_object(LitValue* v, LitValue::Obj&& obj) const {
     assert(v != nullptr);
-    *v = obj;
+    if (obj.get_allocator() == LitValue::Obj::allocator_type(resource)) {
+        LitSetObject(v, std::move(obj));
+        return;
+    }
+    // a buffer of another resource: the keys are copied into ours, the values move
+    LitValue::Obj moved(resource);
+    moved.reserve(obj.size());
+    for (auto& m : obj) {
+        moved.emplace_back(LitValue::String(m.first.data(), m.first.size(), resource), std::move(m.second));
+    }
+    LitSetObject(v, std::move(moved));
+}
+void LitJson::LitSetObject(LitValue* v, LitValue::Obj&& obj) const {
+    LitValue::Obj taken(std::move(obj));
+    v->UnionFree();
+    new (&v->obj) LitValue::ObjData(std::move(taken));
+    v->type = LIT_OBJECT;
+}
+
+void LitJson::LitCopy(LitValue* dst, const LitValue& src) const {
+    assert(dst != nullptr);
+    switch (src.type) {
+        case LIT_STRING: lit_set_string(dst, src.str.data(), src.str.size()); break;
+        case LIT_ARRAY: lit_set_array(dst, src.arr); break;
+        case LIT_OBJECT: lit_set_object(dst, src.obj.members); break;
+        default: *dst = src;
+    }
+}
+
+// unchecked stores into a buffer that LitStringifyLength sized
+struct LitRawWriter {
+    void push_back(char ch) { *p++ = ch; }
+    void append(const char* s, size_t n) {
+        memcpy(p, s, n);
+        p += n;
+    }
+
+    char* p;
+};
+
+#ifdef LIT_ENABLE_STATS
+// forwards to a sink and counts the bytes
+struct LitCountingSink {
+    void push_back(char ch) {
+        ++*count;
+        sink->push_back(ch);
+    }
+    void append(const char* s, size_t n) {
+        *count += n;
+        sink->append(s, n);
+    }
+
+    LitSink* sink;
+    uint64_t* count;
+};
+#endif
+
+// numbers are formatted into a stack buffer and appended, a LitRawWriter already has room for them in place
+template <typename Buffer, typename T>
+static void LitAppendNumber(Buffer* res, int (*format)(T, char*), T x) {
+    char buff[32];
+    res->append(buff, format(x, buff));
+}
+template <typename T>
+static void LitAppendNumber(LitRawWriter* res, int (*format)(T, char*), T x) {
+    res->p += format(x, res->p);
 }
 
-std::string LitJson::LitStringify(const LitValue& v) {
+std::string LitJson::LitStringify(const LitValue& v) const {
+    LIT_STATS_ONLY(LitStats stats);
     std::string res;
-    LitStringifyValue(v, &res);
+    {
+        LIT_STATS_ONLY(LitStatsTimer timer(&stats.stringify_ns));
+        res.assign(LitStringifyLength(v), '\0');
+        LitRawWriter writer{&res[0]};
+        LitStringifyValue(v, &writer);
+        // only an upper bound when v holds fractional doubles, shrinking the size keeps the allocation
+        res.resize(writer.p - res.data());
+    }
+#ifdef LIT_ENABLE_STATS
+    stats.stringifies = 1;
+    stats.bytes_written = res.size();
+    stats.allocations = 1;
+    stats.bytes_allocated = res.capacity() + 1;
+    LitReportStats(stats);
+#endif
     return res;
 }
 
-void LitJson::LitStringifyValue(const LitValue& v, std::string* res) {
+bool LitJson::LitStringify(const LitValue& v, LitSink* sink) const {
+    assert(sink != nullptr);
+#ifdef LIT_ENABLE_STATS
+    LitStats stats;
+    stats.stringifies = 1;
+    bool ok;
+    {
+        LitStatsTimer timer(&stats.stringify_ns);
+        LitCountingSink counter{sink, &stats.bytes_written};
+        LitStringifyValue(v, &counter);
+        ok = sink->LitFlush();
+    }
+    LitReportStats(stats);
+    return ok;
+#else
+    LitStringifyValue(v, sink);
+    return sink->LitFlush();
+#endif
+}
+
+static size_t LitDigitCount(uint64_t u) {
+    size_t n = 1;
+    for (; u >= 10000; u /= 10000) n += 4;
+    return n + (u >= 10) + (u >= 100) + (u >= 1000);
+}
+
+// characters an escape adds: 1 for '"', '\\' and the control characters with a two character escape like \n, 5 for
+// the other control characters (\u00XX), 0 for everything that is copied as is
+static const unsigned char kLitEscapeExtra[256] = {
+    5, 5, 5, 5, 5, 5, 5, 5, 1, 1, 1, 5, 1, 1, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+
+static size_t LitStringLength(const LitValue::String& str) {
+    size_t n = str.size() + 2;
+    for (char ch : str) n += kLitEscapeExtra[static_cast<unsigned char>(ch)];
+    return n;
+}
+
+size_t LitJson::LitStringifyLength(const LitValue& v) const {
+    switch (v.type) {
+        case LIT_NULL: return 4;
+        case LIT_FALSE: return 5;
+        case LIT_TRUE: return 4;
+        case LIT_NUMBER:
+            switch (v.num_type) {
+                case LIT_NUMBER_INT64:
+                    return v.i < 0 ? 1 + LitDigitCount(0 - static_cast<uint64_t>(v.i)) : LitDigitCount(v.i);
+                case LIT_NUMBER_UINT64: return LitDigitCount(v.u);
+                default: {
+                    if (!std::isfinite(v.n)) return 4;
+                    // the cases LitFormatDouble prints without digit generation
+                    double d = std::fabs(v.n);
+                    size_t sign = std::signbit(v.n) ? 1 : 0;
+                    if (d == 0.0) return sign + 1;
+                    if (d < 9007199254740992.0 && d == static_cast<double>(static_cast<uint64_t>(d))) {
+                        return sign + LitDigitCount(static_cast<uint64_t>(d));
+                    }
+                    return 25;
+                }
+            }
+        case LIT_STRING: return LitStringLength(v.str);
+        case LIT_ARRAY: {
+            size_t n = v.arr.empty() ? 2 : v.arr.size() + 1;
+            for (const LitValue& e : v.arr) n += LitStringifyLength(e);
+            return n;
+        }
+        case LIT_OBJECT: {
+            // braces, a colon per member and the commas between them
+            size_t n = v.obj.members.empty() ? 2 : v.obj.members.size() * 2 + 1;
+            for (const auto& m : v.obj.members) n += LitStringLength(m.first) + LitStringifyLength(m.second);
+            return n;
+        }
+    }
+    return 0;
+}
+
+template <typename Buffer>
+void LitJson::LitStringifyValue(const LitValue& v, Buffer* res) const {
     switch (v.type) {
-        case LIT_NULL: *res += "null"; break;
-        case LIT_FALSE: *res += "false"; break;
-        case LIT_TRUE: *res += "true"; break;
+        case LIT_NULL: res->append("null", 4); break;
+        case LIT_FALSE: res->append("false", 5); break;
+        case LIT_TRUE: res->append("true", 4); break;
         case LIT_NUMBER:
-            char buff[32];
-            sprintf(buff, "%.17g", v.n);
-            *res += buff;
+            switch (v.num_type) {
+                case LIT_NUMBER_DOUBLE:
+                    // JSON has no NaN or infinity, like JSON.stringify they become null
+                    if (std::isfinite(v.n)) {
+                        LitAppendNumber(res, LitFormatDouble, v.n);
+                    } else {
+                        res->append("null", 4);
+                    }
+                    break;
+                case LIT_NUMBER_INT64: LitAppendNumber(res, LitFormatInt64, v.i); break;
+                case LIT_NUMBER_UINT64: LitAppendNumber(res, LitFormatUint64, v.u); break;
+            }
             break;
         case LIT_STRING: LitStringifyString(v.str, res); break;
         case LIT_ARRAY:
@@ -388,37 +741,42 @@ void LitJson::LitStringifyValue(const LitValue& v, std::string* res) {
             break;
         case LIT_OBJECT:
             res->push_back('{');
-            for (int i = 0; i < v.obj.size(); ++i) {
+            for (int i = 0; i < v.obj.members.size(); ++i) {
                 if (i > 0) res->push_back(',');
-                LitStringifyString(v.obj[i].first, res);
+                LitStringifyString(v.obj.members[i].first, res);
                 res->push_back(':');
-                LitStringifyValue(v.obj[i].second, res);
+                LitStringifyValue(v.obj.members[i].second, res);
             }
             res->push_back('}');
             break;
     }
 }
 
-void LitJson::LitStringifyString(const std::string& str, std::string* res) {
+template <typename Buffer>
+void LitJson::LitStringifyString(const LitValue::String& str, Buffer* res) const {
     res->push_back('\"');
-    for (int i = 0; i < str.size(); ++i) {
-        unsigned char ch = static_cast<unsigned char>(str[i]);
+    const char* p = str.data();
+    const char* end = p + str.size();
+    while (true) {
+        // copy the run of characters that need no escape in one go
+        const char* run = p;
+        while (p < end && kLitEscapeExtra[static_cast<unsigned char>(*p)] == 0) ++p;
+        res->append(run, p - run);
+        if (p == end) break;
+        unsigned char ch = static_cast<unsigned char>(*p++);
         switch (ch) {
-            case '\"': *res += "\\\""; break;
-            case '\\': *res += "\\\\"; break;
-            case '\b': *res += "\\b"; break;
-            case '\f': *res += "\\f"; break;
-            case '\n': *res += "\\n"; break;
-            case '\r': *res += "\\r"; break;
-            case '\t': *res += "\\t"; break;
-            default:
-                if (ch < 0x20) {
-                    char buff[7] = {'\0'};
-                    sprintf(buff, "\\u%04X", ch);
-                    *res += buff;
-                } else {
-                    res->push_back(ch);
-                }
+            case '\"': res->append("\\\"", 2); break;
+            case '\\': res->append("\\\\", 2); break;
+            case '\b': res->append("\\b", 2); break;
+            case '\f': res->append("\\f", 2); break;
+            case '\n': res->append("\\n", 2); break;
+            case '\r': res->append("\\r", 2); break;
+            case '\t': res->append("\\t", 2); break;
+            default: {
+                char buff[7] = {'\0'};
+                sprintf(buff, "\\u%04X", ch);
+                res->append(buff, 6);
+            }
         }
     }
     res->push_back('\"');
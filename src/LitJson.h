@@ -1,11 +1,16 @@
 #ifndef LITJSON_H_
 #define LITJSON_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "LitStats.h"
 #include "LitValue.h"
 
+class LitShapeCache;
+class LitSink;
+
 enum ParseResultType {
     LIT_PARSE_OK = 0,
     LIT_PARSE_EXPECT_VALUE,
@@ -20,64 +25,260 @@ enum ParseResultType {
     LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET,
     LIT_PARSE_MISS_KEY,
     LIT_PARSE_MISS_COLON,
-    LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET
+    LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+    LIT_PARSE_TERMINATED,  // a LitReader handler returned false
+    LIT_PARSE_FILE_ERROR,     // LitParseFile could not open or map the file
+    LIT_PARSE_DEPTH_EXCEEDED  // arrays and objects nested deeper than lit_get_max_depth()
 };
 
+// Stateless parser and accessors. Every member is const and keeps its state in locals, so one LitJson (or the
+// same instance shared by all threads) can parse, stringify and read values concurrently without locking. Writing
+// to a LitValue while another thread reads it still needs outside synchronization. Settings like the maximum depth
+// are made before the instance is shared.
 class LitJson {
 public:
-    LitJson() = default;
+    // values are created with the default resource at the time of construction, see LitMemory.h
+    LitJson() : resource(lit_get_default_resource()) {}
+    // every string, array and object this LitJson creates comes from resource: parsed and decoded trees, setter
+    // copies and LitCopy. Values it did not create keep their memory when moved in. The lookup index of a large
+    // object is the exception, see LitMemory.h.
+    explicit LitJson(LitMemoryResource* resource) : resource(resource) {}
 
     // Json Parse
-    ParseResultType LitParse(LitValue* v, const char* json);
+    ParseResultType LitParse(LitValue* v, const char* json) const;
+    // parse exactly len bytes, json needs no terminator. Nothing past json + len is parsed, but the SSE2/AVX2 string
+    // scan loads whole aligned 16 or 32-byte blocks and may read up to the end of the block holding the last byte.
+    // That block lies within the page of the last byte so the load cannot fault, and the bytes read are ignored: the
+    // scan only runs on a string whose closing quote comes before json + len and stops there (see LitSimd.h).
+    // A '\0' inside a value fails like the end of the text in the overload above, but it is not the end: the bytes
+    // after it are still parsed and must be whitespace, a '\0' after the root is LIT_PARSE_ROOT_NOT_SINGULAR.
+    ParseResultType LitParse(LitValue* v, const char* json, size_t len) const;
+    // the same with keys and object shapes learned in cache, see LitShapeCache. Records that repeat a layout skip
+    // decoding their keys and allocate their members once. The tree is the same as without a cache.
+    ParseResultType LitParse(LitValue* v, const char* json, size_t len, LitShapeCache* cache) const;
+    // parse a file through a read-only memory mapping, the text is never copied into a buffer
+    ParseResultType LitParseFile(LitValue* v, const char* path) const;
+
+    // Arrays and objects may be nested this deep in parsed text and decoded MessagePack / CBOR, one level more fails
+    // with LIT_PARSE_DEPTH_EXCEEDED. The parser keeps open containers on an explicit stack instead of recursing. The
+    // limit bounds that stack, and the recursion of stringify, copies and destruction on a tree parsed here or by a
+    // LitPushParser, LitDocument or LitReader, which all enforce it. Trees nested by hand through the setters are not
+    // checked.
+    static const size_t kDefaultMaxDepth = 512;
+    size_t lit_get_max_depth() const { return max_depth; }
+    void lit_set_max_depth(size_t depth) { max_depth = depth; }
     // Json Stringify
-    std::string LitStringify(const LitValue& v);
+    // sized by LitStringifyLength first, the text is written into a single allocation without capacity checks
+    std::string LitStringify(const LitValue& v) const;
+    // stream the text into sink and flush it, the memory used stays at the sink's buffer however large v is. false
+    // if the sink failed (a write error, a full LitBufferSink, a callback that returned false).
+    bool LitStringify(const LitValue& v, LitSink* sink) const;
+    // length of LitStringify(v), exact except for doubles that are not whole numbers below 2^53: those are
+    // counted as the 25 characters LitFormatDouble may need
+    size_t LitStringifyLength(const LitValue& v) const;
+
+    // MessagePack and CBOR (RFC 8949) carry the same LitValue trees in binary. The decoders read exactly len bytes
+    // and fail like LitParse, leaving v null: the data ends inside a value -> EXPECT_VALUE, bytes after the root ->
+    // ROOT_NOT_SINGULAR, a map key that is not a string -> MISS_KEY, a NaN or infinite float -> NUMBER_TOO_BIG,
+    // anything JSON has no value for (binary and extension types, CBOR byte strings and simple values) ->
+    // INVALID_VALUE. Integers are stored like LitParse stores them.
+    ParseResultType LitParseMsgPack(LitValue* v, const char* data, size_t len) const;
+    // tags are skipped and the tagged item is read as is, indefinite lengths are accepted, undefined reads as null
+    ParseResultType LitParseCbor(LitValue* v, const char* data, size_t len) const;
+    // the shortest form of every head and integer, doubles that a float holds exactly take 4 bytes instead of 8
+    std::string LitEncodeMsgPack(const LitValue& v) const;
+    bool LitEncodeMsgPack(const LitValue& v, LitSink* sink) const;
+    std::string LitEncodeCbor(const LitValue& v) const;
+    bool LitEncodeCbor(const LitValue& v, LitSink* sink) const;
 
     // setter and getter function
-    LitType lit_get_type(const LitValue& v);
+    LitType lit_get_type(const LitValue& v) const;
+
+    void lit_set_null(LitValue* v) const;
+
+    bool lit_get_boolean(const LitValue& v) const;
+    void lit_set_boolean(LitValue* v, bool b) const;
 
-    void lit_set_null(LitValue* v);
+    // integers are converted, above 2^53 that may round
+    double lit_get_number(const LitValue& v) const;
+    // n must be finite, a NaN or infinity assigned to a LitValue directly is stringified as null
+    void lit_set_number(LitValue* v, double n) const;
 
-    bool lit_get_boolean(const LitValue& v);
-    void lit_set_boolean(LitValue* v, bool b);
+    LitNumberType lit_get_number_type(const LitValue& v) const;
+    int64_t lit_get_int64(const LitValue& v) const;
+    void lit_set_int64(LitValue* v, int64_t i) const;
+    // also valid for non-negative int64 numbers
+    uint64_t lit_get_uint64(const LitValue& v) const;
+    void lit_set_uint64(LitValue* v, uint64_t u) const;
 
-    double lit_get_number(const LitValue& v);
-    void lit_set_number(LitValue* v, double n);
+    const LitValue::String& lit_get_string(const LitValue& v) const;
+    void lit_set_string(LitValue* v, const std::string& s) const;
+    void lit_set_string(LitValue* v, const char* s) const;
+    void lit_set_string(LitValue* v, const char* s, size_t len) const;
+    // keeps the buffer of s when it comes from this LitJson's resource, otherwise copies it into one of ours
+    void lit_set_string(LitValue* v, LitValue::String&& s) const;
 
-    std::string lit_get_string(const LitValue& v);
-    void lit_set_string(LitValue* v, const std::string& s);
+    LitValue& lit_get_array_element(LitValue& v, size_t index) const;
+    const LitValue& lit_get_array_element(const LitValue& v, size_t index) const;
 
-    LitValue& lit_get_array_element(LitValue& v, size_t index);
-    const LitValue& lit_get_array_element(const LitValue& v, size_t index);
+    size_t lit_get_array_size(const LitValue& v) const;
+    // a const array or object is deep copied into this LitJson's resource. One passed by rvalue keeps its buffer when
+    // it comes from the same resource, otherwise the elements move into a buffer of ours.
+    void lit_set_array(LitValue* v, const LitValue::Array& a) const;
+    void lit_set_array(LitValue* v, LitValue::Array&& a) const;
 
-    size_t lit_get_array_size(const LitValue& v);
-    void lit_set_array(LitValue* v, const std::vector<LitValue>& a);
+    size_t lit_get_object_size(const LitValue& v) const;
+    const LitValue::String& lit_get_object_key(const LitValue& v, size_t index) const;
+    size_t lit_get_object_key_length(const LitValue& v, size_t index) const;
+    LitValue& lit_get_object_value(LitValue& v, size_t index) const;
+    const LitValue& lit_get_object_value(const LitValue& v, size_t index) const;
+    // first member named key, LIT_KEY_NOT_EXIST / nullptr if there is none. Objects of at least
+    // LitObjectIndex::kThreshold members build a hash index on the first lookup, later lookups are O(1) until the
+    // object is assigned again. Concurrent lookups into the same object are safe.
+    size_t lit_find_object_index(const LitValue& v, const char* key, size_t klen) const;
+    LitValue* lit_find_object_value(LitValue& v, const char* key, size_t klen) const;
+    const LitValue* lit_find_object_value(const LitValue& v, const char* key, size_t klen) const;
+    void lit_set_object(LitValue* v, const LitValue::Obj& obj) const;
+    void lit_set_object(LitValue* v, LitValue::Obj&& obj) const;
+    // deep copy of src with every string, array and object from this LitJson's resource
+    void LitCopy(LitValue* dst, const LitValue& src) const;
 
-    size_t lit_get_object_size(const LitValue& v);
-    const std::string& lit_get_object_key(const LitValue& v, size_t index);
-    size_t lit_get_object_key_length(const LitValue& v, size_t index);
-    LitValue& lit_get_object_value(LitValue& v, size_t index);
-    void lit_set_object(LitValue* v, const LitValue::Obj& obj);
+    LitMemoryResource* lit_get_resource() const { return resource; }
 
 private:
+    // an array or object the parser is inside of, the innermost is on top of the stack
+    struct LitParseFrame {
+        LitParseFrame(bool object, LitMemoryResource* resource)
+            : object(object), elements(resource), members(resource) {}
+
+        bool object;
+        LitValue::Array elements;
+        LitValue::Obj members;
+        // objects with a cache: the shape of the member holding this object, of the last key and of the first
+        uint32_t outer;
+        uint32_t shape;
+        uint32_t first;
+#ifdef LIT_ENABLE_STATS
+        size_t capacity = 0;
+#endif
+    };
+
+    // the state of one LitParse call, it lives on the caller's stack
+    struct LitParseContext {
+        char LitPeek() const { return cur != end ? *cur : '\0'; }
+
+        const char* cur = nullptr;
+        const char* begin = nullptr;
+        const char* end = nullptr;  // the last character before end is never whitespace
+        // tokens may only run into end inside a number (number_at_end) or inside a string starting at or after
+        // last_quote (found on first use), those are decoded from a terminated copy in tail
+        bool number_at_end = false;
+        const char* last_quote = nullptr;
+        std::string tail;
+
+        const uint32_t* next_structural = nullptr;  // nullptr when parsing without the index
+        // with a cache: the shape of the member whose value is being parsed, LitShapeCache::kEmpty at the root
+        LitShapeCache* shapes = nullptr;
+        uint32_t member_shape = 0;
+        // the open containers, reused by every parse on the thread and left empty
+        std::vector<LitParseFrame>* stack = nullptr;
+
+#ifdef LIT_ENABLE_STATS
+        // a buffer that now holds bytes instead of *last is one more allocation
+        void LitCountBuffer(size_t bytes, size_t* last) {
+            if (bytes == *last) return;
+            ++stats.allocations;
+            stats.bytes_allocated += bytes;
+            *last = bytes;
+        }
+        void LitCountString(const LitValue::String& s) {
+            static const size_t kSmallString = LitValue::String().capacity();
+            if (s.capacity() > kSmallString) {
+                ++stats.allocations;
+                stats.bytes_allocated += s.capacity() + 1;
+            }
+        }
+
+        LitStats stats;
+        uint64_t depth = 0;
+#endif
+    };
+
+    // the state of one LitParseMsgPack / LitParseCbor call
+    struct LitBinaryContext {
+        // the next bytes as a big-endian unsigned integer, false if the data ends first
+        bool LitReadUint(int bytes, uint64_t* x) {
+            if (end - cur < bytes) return false;
+            uint64_t r = 0;
+            for (int i = 0; i < bytes; ++i) r = r << 8 | cur[i];
+            cur += bytes;
+            *x = r;
+            return true;
+        }
+        // append the next n bytes to s, false if the data ends first
+        bool LitReadBytes(uint64_t n, LitValue::String* s) {
+            if (static_cast<uint64_t>(end - cur) < n) return false;
+            s->append(reinterpret_cast<const char*>(cur), static_cast<size_t>(n));
+            cur += n;
+            return true;
+        }
+        // elements still to read can't outnumber the bytes left, so a count from the data never over-reserves
+        size_t LitCapacity(uint64_t count, size_t min_size) const {
+            size_t left = (end - cur) / min_size;
+            return count < left ? static_cast<size_t>(count) : left;
+        }
+
+        const unsigned char* cur = nullptr;
+        const unsigned char* end = nullptr;
+        size_t depth = 0;  // containers and CBOR tags the decoder is inside of
+    };
+
     // parse
-    void LitParseWhitespace();
-    ParseResultType LitParseNull(LitValue* v);
-    ParseResultType LitParseTrue(LitValue* v);
-    ParseResultType LitParseFalse(LitValue* v);
-    ParseResultType LitParseValue(LitValue* v);
-    ParseResultType LitParseNumber(LitValue* v);
-    ParseResultType LitParseStringRaw(std::string* buff);
-    ParseResultType LitParseString(LitValue* v);
-    ParseResultType LitParseArray(LitValue* v);
-    ParseResultType LitParseObject(LitValue* v);
-    const char* LitParseUnicode(const char* p, unsigned int* u);
-    void LitEncodeUTF8(std::string* buff, unsigned int u);
-
-    // stringify
-    void LitStringifyValue(const LitValue& v, std::string* res);
-    void LitStringifyString(const std::string& str, std::string* res);
-
-    const char* cur = nullptr;
+    static const char* LitLastQuote(LitParseContext* c);
+    static void LitParseWhitespace(LitParseContext* c);
+    ParseResultType LitParseNull(LitParseContext* c, LitValue* v) const;
+    ParseResultType LitParseTrue(LitParseContext* c, LitValue* v) const;
+    ParseResultType LitParseFalse(LitParseContext* c, LitValue* v) const;
+    ParseResultType LitParseValue(LitParseContext* c, LitValue* v) const;
+    ParseResultType LitParseNumber(LitParseContext* c, LitValue* v) const;
+    ParseResultType LitParseStringRaw(LitParseContext* c, LitValue::String* buff) const;
+    ParseResultType LitParseString(LitParseContext* c, LitValue* v) const;
+    // the key of the next member of f and its colon, the member is added with a null value
+    ParseResultType LitParseMember(LitParseContext* c, LitParseFrame* f) const;
+    // the closed f moved into v
+    void LitCloseFrame(LitParseContext* c, LitParseFrame* f, LitValue* v) const;
+
+    // stringify, Buffer is std::string or LitSink
+    template <typename Buffer>
+    void LitStringifyValue(const LitValue& v, Buffer* res) const;
+    template <typename Buffer>
+    void LitStringifyString(const LitValue::String& str, Buffer* res) const;
+
+    // MessagePack and CBOR, in LitBinary.cpp
+    ParseResultType LitParseMsgPackValue(LitBinaryContext* c, LitValue* v) const;
+    ParseResultType LitParseMsgPackString(LitBinaryContext* c, LitValue::String* s) const;
+    static ParseResultType LitParseCborHead(LitBinaryContext* c, unsigned* major, uint64_t* n, bool* indefinite);
+    ParseResultType LitParseCborValue(LitBinaryContext* c, LitValue* v) const;
+    ParseResultType LitParseCborString(LitBinaryContext* c, LitValue::String* s) const;
+    template <typename Buffer>
+    void LitEncodeMsgPackValue(const LitValue& v, Buffer* res) const;
+    template <typename Buffer>
+    void LitEncodeCborValue(const LitValue& v, Buffer* res) const;
+
+    // move a container built from any resource into v
+    void LitSetString(LitValue* v, LitValue::String&& s) const;
+    void LitSetArray(LitValue* v, LitValue::Array&& a) const;
+    void LitSetObject(LitValue* v, LitValue::Obj&& obj) const;
+
+    // Texts of at least kStructuralIndexThreshold bytes that are mostly whitespace are parsed in two stages:
+    // LitBuildStructuralIndex records where tokens start, then the parser jumps over whitespace through that index.
+    // Compact text gains nothing from the extra pass and is parsed directly
+    static const size_t kStructuralIndexThreshold = 64 * 1024;
+    // the per-thread index is kept for the next parse up to this many entries (4 MiB), a larger one is freed
+    static const size_t kStructuralIndexRetained = 1 << 20;
+
+    LitMemoryResource* resource;
+    size_t max_depth = kDefaultMaxDepth;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,280 @@
+#include "LitLazy.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "LitStructural.h"
+
+ParseResultType LitLazyDocument::LitParse(const char* json) {
+    assert(json != nullptr);
+    return LitParse(json, strlen(json));
+}
+
+ParseResultType LitLazyDocument::LitParse(const char* json, size_t len) {
+    assert((json != nullptr || len == 0) && len < 0xFFFFFFFFu);
+    this->json = json != nullptr ? json : "";
+    this->len = len;
+    root = LitLazyValue();
+    LitBuildStructuralIndex(this->json, len, &structural);
+    match.resize(structural.size());
+
+    ParseResultType res = LitCheckStructure();
+    if (res == LIT_PARSE_OK) root = LitLazyValue(0);
+    return res;
+}
+
+const char* LitLazyDocument::LitTokenEnd(uint32_t t) const {
+    const char* first = json + structural[t];
+    const char* p = json + structural[t + 1];
+    while (p > first && LitIsWhitespace(p[-1])) --p;
+    return p;
+}
+
+ParseResultType LitLazyDocument::LitCheckStructure() {
+    // the grammar of LitJson::LitParse over the index entries, with an explicit stack of open brackets
+    enum { VALUE, KEY, AFTER_VALUE } state = VALUE;
+    const uint32_t* index = structural.data();
+    const uint32_t last = static_cast<uint32_t>(structural.size() - 1);  // the terminator entry
+    uint32_t t = 0;
+    stack.clear();
+    while (true) {
+        char ch = t < last ? json[index[t]] : '\0';
+        switch (state) {
+            case VALUE:
+                switch (ch) {
+                    case '\0': return LIT_PARSE_EXPECT_VALUE;
+                    case '[':
+                    case '{':
+                        stack.push_back(t++);
+                        if (LitTokenChar(t) == (ch == '[' ? ']' : '}')) {
+                            match[stack.back()] = t++;
+                            stack.pop_back();
+                            state = AFTER_VALUE;
+                        } else {
+                            state = ch == '[' ? VALUE : KEY;
+                        }
+                        continue;
+                    case '\"': break;
+                    case 'n':
+                    case 't':
+                    case 'f': {
+                        const char* literal = ch == 'n' ? "null" : ch == 't' ? "true" : "false";
+                        size_t n = strlen(literal);
+                        const char* p = json + structural[t];
+                        if (static_cast<size_t>(LitTokenEnd(t) - p) != n || memcmp(p, literal, n) != 0) {
+                            return LIT_PARSE_INVALID_VALUE;
+                        }
+                        ++t;
+                        state = AFTER_VALUE;
+                        continue;
+                    }
+                    default:
+                        // the rest of a number is checked when it is read
+                        if (ch != '-' && (ch < '0' || ch > '9')) return LIT_PARSE_INVALID_VALUE;
+                        ++t;
+                        state = AFTER_VALUE;
+                        continue;
+                }
+                // a string value is checked like a key
+                // fall through
+            case KEY: {
+                if (ch != '\"') return LIT_PARSE_MISS_KEY;
+                // the string must end in a quotation mark that is not escaped, right before the next entry
+                const char* first = json + structural[t];
+                const char* p = LitTokenEnd(t);
+                size_t run = 0;
+                if (p - first < 2 || p[-1] != '\"') return LIT_PARSE_MISS_QUOTATION_MARK;
+                while (p - 2 - run > first && p[-2 - static_cast<ptrdiff_t>(run)] == '\\') ++run;
+                if (run % 2 != 0) return LIT_PARSE_MISS_QUOTATION_MARK;
+                ++t;
+                if (state == KEY) {
+                    if (LitTokenChar(t) != ':') return LIT_PARSE_MISS_COLON;
+                    ++t;
+                    state = VALUE;
+                } else {
+                    state = AFTER_VALUE;
+                }
+                continue;
+            }
+            case AFTER_VALUE: {
+                if (stack.empty()) return t == last ? LIT_PARSE_OK : LIT_PARSE_ROOT_NOT_SINGULAR;
+                bool object = LitTokenChar(stack.back()) == '{';
+                if (ch == ',') {
+                    ++t;
+                    state = object ? KEY : VALUE;
+                } else if (ch == (object ? '}' : ']')) {
+                    match[stack.back()] = t++;
+                    stack.pop_back();
+                } else {
+                    return object ? LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                }
+                continue;
+            }
+        }
+    }
+}
+
+LitType LitLazyDocument::lit_get_type(const LitLazyValue& v) const {
+    assert(v.lit_is_valid());
+    switch (LitTokenChar(v.tok)) {
+        case 'n': return LIT_NULL;
+        case 't': return LIT_TRUE;
+        case 'f': return LIT_FALSE;
+        case '\"': return LIT_STRING;
+        case '[': return LIT_ARRAY;
+        case '{': return LIT_OBJECT;
+        default: return LIT_NUMBER;
+    }
+}
+
+bool LitLazyDocument::lit_get_boolean(const LitLazyValue& v) const {
+    assert(lit_get_type(v) == LIT_TRUE || lit_get_type(v) == LIT_FALSE);
+    return LitTokenChar(v.tok) == 't';
+}
+
+ParseResultType LitLazyDocument::LitReadNumber(const LitLazyValue& v, LitDecodedNumber* num) const {
+    assert(lit_get_type(v) == LIT_NUMBER);
+    const char* p = json + structural[v.tok];
+    const char* end = LitTokenEnd(v.tok);
+    ParseResultType res;
+    if (end == json + len) {
+        // the number runs into the end of the text, decode a terminated copy
+        std::string tail(p, end);
+        const char* t = tail.c_str();
+        res = LitDecodeNumber(&t, num);
+        p += t - tail.c_str();
+    } else {
+        res = LitDecodeNumber(&p, num);
+    }
+    // e.g. "0123" or "1x", something that is not a number follows without a separator
+    if (res == LIT_PARSE_OK && p != end) res = LIT_PARSE_INVALID_VALUE;
+    return res;
+}
+
+ParseResultType LitLazyDocument::lit_get_number(const LitLazyValue& v, double* n) const {
+    assert(n != nullptr);
+    LitDecodedNumber num;
+    ParseResultType res = LitReadNumber(v, &num);
+    if (res != LIT_PARSE_OK) return res;
+    switch (num.type) {
+        case LIT_NUMBER_INT64: *n = static_cast<double>(num.i); break;
+        case LIT_NUMBER_UINT64: *n = static_cast<double>(num.u); break;
+        default: *n = num.d;
+    }
+    return LIT_PARSE_OK;
+}
+
+ParseResultType LitLazyDocument::lit_get_number_type(const LitLazyValue& v, LitNumberType* type) const {
+    assert(type != nullptr);
+    LitDecodedNumber num;
+    ParseResultType res = LitReadNumber(v, &num);
+    if (res == LIT_PARSE_OK) *type = num.type;
+    return res;
+}
+
+ParseResultType LitLazyDocument::lit_get_int64(const LitLazyValue& v, int64_t* i) const {
+    assert(i != nullptr);
+    LitDecodedNumber num;
+    ParseResultType res = LitReadNumber(v, &num);
+    if (res != LIT_PARSE_OK) return res;
+    if (num.type != LIT_NUMBER_INT64) return LIT_PARSE_INVALID_VALUE;
+    *i = num.i;
+    return LIT_PARSE_OK;
+}
+
+ParseResultType LitLazyDocument::lit_get_uint64(const LitLazyValue& v, uint64_t* u) const {
+    assert(u != nullptr);
+    LitDecodedNumber num;
+    ParseResultType res = LitReadNumber(v, &num);
+    if (res != LIT_PARSE_OK) return res;
+    if (num.type == LIT_NUMBER_UINT64) {
+        *u = num.u;
+    } else if (num.type == LIT_NUMBER_INT64 && num.i >= 0) {
+        *u = static_cast<uint64_t>(num.i);
+    } else {
+        return LIT_PARSE_INVALID_VALUE;
+    }
+    return LIT_PARSE_OK;
+}
+
+ParseResultType LitLazyDocument::lit_get_string(const LitLazyValue& v, std::string* s) const {
+    assert(lit_get_type(v) == LIT_STRING && s != nullptr);
+    // LitCheckStructure made sure the closing quotation mark is there, the decoder stops at it
+    const char* p = json + structural[v.tok];
+    std::string buff;
+    ParseResultType res = LitDecodeString(&p, &buff);
+    if (res == LIT_PARSE_OK) s->swap(buff);
+    return res;
+}
+
+size_t LitLazyDocument::lit_get_array_size(const LitLazyValue& v) const {
+    size_t size = 0;
+    for (LitLazyValue e = lit_get_first_element(v); e.lit_is_valid(); e = lit_get_next_element(e)) ++size;
+    return size;
+}
+
+LitLazyValue LitLazyDocument::lit_get_array_element(const LitLazyValue& v, size_t index) const {
+    LitLazyValue e = lit_get_first_element(v);
+    for (; e.lit_is_valid() && index > 0; --index) e = lit_get_next_element(e);
+    return e;
+}
+
+LitLazyValue LitLazyDocument::lit_get_first_element(const LitLazyValue& v) const {
+    assert(lit_get_type(v) == LIT_ARRAY);
+    return v.tok + 1 == match[v.tok] ? LitLazyValue() : LitLazyValue(v.tok + 1);
+}
+
+LitLazyValue LitLazyDocument::lit_get_next_element(const LitLazyValue& element) const {
+    assert(element.lit_is_valid());
+    uint32_t t = LitSkip(element.tok);
+    return LitTokenChar(t) == ',' ? LitLazyValue(t + 1) : LitLazyValue();
+}
+
+size_t LitLazyDocument::lit_get_object_size(const LitLazyValue& v) const {
+    size_t size = 0;
+    for (LitLazyValue k = lit_get_first_member(v); k.lit_is_valid(); k = lit_get_next_member(k)) ++size;
+    return size;
+}
+
+LitLazyValue LitLazyDocument::lit_find_object_value(const LitLazyValue& v, const char* key, size_t klen) const {
+    assert(key != nullptr);
+    std::string decoded;
+    for (LitLazyValue k = lit_get_first_member(v); k.lit_is_valid(); k = lit_get_next_member(k)) {
+        const char* first = json + structural[k.tok] + 1;
+        const char* last = LitTokenEnd(k.tok) - 1;  // the closing quotation mark
+        if (memchr(first, '\\', last - first) == nullptr) {
+            if (static_cast<size_t>(last - first) == klen && memcmp(first, key, klen) == 0) {
+                return lit_get_member_value(k);
+            }
+        } else if (lit_get_string(k, &decoded) == LIT_PARSE_OK && decoded.size() == klen &&
+                   memcmp(decoded.data(), key, klen) == 0) {
+            return lit_get_member_value(k);
+        }
+    }
+    return LitLazyValue();
+}
+
+LitLazyValue LitLazyDocument::lit_get_first_member(const LitLazyValue& v) const {
+    assert(lit_get_type(v) == LIT_OBJECT);
+    return v.tok + 1 == match[v.tok] ? LitLazyValue() : LitLazyValue(v.tok + 1);
+}
+
+LitLazyValue LitLazyDocument::lit_get_next_member(const LitLazyValue& key) const {
+    assert(lit_get_type(key) == LIT_STRING);
+    // key ':' value
+    uint32_t t = LitSkip(key.tok + 2);
+    return LitTokenChar(t) == ',' ? LitLazyValue(t + 1) : LitLazyValue();
+}
+
+LitLazyValue LitLazyDocument::lit_get_member_value(const LitLazyValue& key) const {
+    assert(lit_get_type(key) == LIT_STRING);
+    return LitLazyValue(key.tok + 2);
+}
+
+ParseResultType LitLazyDocument::lit_to_value(const LitLazyValue& v, LitValue* res) const {
+    assert(v.lit_is_valid() && res != nullptr);
+    const char* first = json + structural[v.tok];
+    char ch = LitTokenChar(v.tok);
+    const char* last = ch == '[' || ch == '{' ? json + structural[match[v.tok]] + 1 : LitTokenEnd(v.tok);
+    return LitJson().LitParse(res, first, last - first);
+}
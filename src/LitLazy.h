@@ -0,0 +1,105 @@
+#ifndef LITLAZY_H_
+#define LITLAZY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LitDecode.h"
+#include "LitJson.h"
+#include "LitValue.h"
+
+// A value inside a LitLazyDocument, only its position in the document's structural index. Handles are trivially
+// copyable and stay valid until the document parses another text.
+class LitLazyValue {
+    friend class LitLazyDocument;
+
+public:
+    LitLazyValue() = default;
+
+    // false for the handle after the last element or member and for lookups that found nothing
+    bool lit_is_valid() const { return tok != kNone; }
+
+private:
+    static const uint32_t kNone = 0xFFFFFFFFu;
+
+    explicit LitLazyValue(uint32_t tok) : tok(tok) {}
+
+    uint32_t tok = kNone;  // index entry of the value's first character
+};
+
+// On-demand document for reading a few fields out of a large text. LitParse runs the structural index over the
+// text and checks its structure once: brackets, commas, colons, keys, that every string is closed and that
+// literals are spelled right. Nothing is converted or copied, every bracket just remembers where it is closed,
+// so skipping a sibling subtree is a single jump. Numbers and strings are decoded (and checked) only when they
+// are read, a broken number or escape is reported by the getter instead of by LitParse.
+//
+// The text is not copied and must outlive the document. Texts must be smaller than 4 GiB.
+class LitLazyDocument {
+public:
+    LitLazyDocument() = default;
+    LitLazyDocument(const LitLazyDocument&) = delete;
+    LitLazyDocument& operator=(const LitLazyDocument&) = delete;
+
+    // on error the root is invalid. A text LitJson::LitParse rejects is rejected here too, by LitParse or at the
+    // latest by the getter that reads the broken token, but the code can differ when the first break is inside a
+    // number or string.
+    ParseResultType LitParse(const char* json);
+    // a '\0' inside the text is an invalid character
+    ParseResultType LitParse(const char* json, size_t len);
+
+    // getter function, const and safe to call from several threads on a parsed document
+    LitLazyValue lit_get_root() const { return root; }
+    // from the first character, numbers are not checked
+    LitType lit_get_type(const LitLazyValue& v) const;
+
+    bool lit_get_boolean(const LitLazyValue& v) const;
+    // these decode the token on every call, the result is only set on LIT_PARSE_OK. lit_get_int64 and
+    // lit_get_uint64 fail with LIT_PARSE_INVALID_VALUE for numbers of another LitNumberType.
+    ParseResultType lit_get_number(const LitLazyValue& v, double* n) const;
+    ParseResultType lit_get_number_type(const LitLazyValue& v, LitNumberType* type) const;
+    ParseResultType lit_get_int64(const LitLazyValue& v, int64_t* i) const;
+    ParseResultType lit_get_uint64(const LitLazyValue& v, uint64_t* u) const;
+    // also reads object keys, see lit_get_first_member
+    ParseResultType lit_get_string(const LitLazyValue& v, std::string* s) const;
+
+    // O(size), elements are counted by jumping from one to the next
+    size_t lit_get_array_size(const LitLazyValue& v) const;
+    LitLazyValue lit_get_array_element(const LitLazyValue& v, size_t index) const;
+    // iteration: invalid for an empty array / after the last element
+    LitLazyValue lit_get_first_element(const LitLazyValue& v) const;
+    LitLazyValue lit_get_next_element(const LitLazyValue& element) const;
+
+    size_t lit_get_object_size(const LitLazyValue& v) const;
+    // first member named key, an invalid handle if there is none. Keys without escapes are compared in place.
+    LitLazyValue lit_find_object_value(const LitLazyValue& v, const char* key, size_t klen) const;
+    // iteration over the keys: invalid for an empty object / after the last member
+    LitLazyValue lit_get_first_member(const LitLazyValue& v) const;
+    LitLazyValue lit_get_next_member(const LitLazyValue& key) const;
+    LitLazyValue lit_get_member_value(const LitLazyValue& key) const;
+
+    // materialize a whole subtree with LitJson, this checks every number and string in it
+    ParseResultType lit_to_value(const LitLazyValue& v, LitValue* res) const;
+
+private:
+    char LitTokenChar(uint32_t t) const { return t + 1 < structural.size() ? json[structural[t]] : '\0'; }
+    // end of the token starting at entry t: after its last non-whitespace character before the next entry
+    const char* LitTokenEnd(uint32_t t) const;
+    // the entry right after the value starting at entry t
+    uint32_t LitSkip(uint32_t t) const {
+        char ch = LitTokenChar(t);
+        return ch == '[' || ch == '{' ? match[t] + 1 : t + 1;
+    }
+    ParseResultType LitCheckStructure();
+    ParseResultType LitReadNumber(const LitLazyValue& v, LitDecodedNumber* num) const;
+
+    const char* json = nullptr;
+    size_t len = 0;
+    LitLazyValue root;
+    std::vector<uint32_t> structural;
+    std::vector<uint32_t> match;  // for entries of '[' and '{': the entry of the matching bracket
+    std::vector<uint32_t> stack;  // scratch for LitCheckStructure, reused across parses
+};
+
+#endif
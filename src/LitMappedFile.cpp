@@ -0,0 +1,80 @@
+#include "LitMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+bool LitMappedFile::Open(const char* path) {
+    Close();
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(f, &size)) {
+        CloseHandle(f);
+        return false;
+    }
+    file = f;
+    len = static_cast<size_t>(size.QuadPart);
+    if (len == 0) return true;
+
+    // mapping an empty file fails, so only non-empty files get a view
+    mapping = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping != nullptr) map = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (map == nullptr) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void LitMappedFile::Close() {
+    if (map != nullptr) UnmapViewOfFile(map);
+    if (mapping != nullptr) CloseHandle(mapping);
+    if (file != nullptr) CloseHandle(file);
+    map = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    len = 0;
+}
+#else
+bool LitMappedFile::Open(const char* path) {
+    Close();
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    len = static_cast<size_t>(st.st_size);
+    if (len == 0) {
+        close(fd);
+        return true;
+    }
+
+    // the mapping keeps its own reference to the file
+    void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        len = 0;
+        return false;
+    }
+    // the parser reads front to back, let the kernel read ahead aggressively
+    madvise(p, len, MADV_SEQUENTIAL);
+    map = static_cast<const char*>(p);
+    return true;
+}
+
+void LitMappedFile::Close() {
+    if (map != nullptr) munmap(const_cast<char*>(map), len);
+    map = nullptr;
+    len = 0;
+}
+#endif
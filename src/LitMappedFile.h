@@ -0,0 +1,31 @@
+#ifndef LITMAPPEDFILE_H_
+#define LITMAPPEDFILE_H_
+
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. The pages are loaded by the OS as the parser touches them, nothing is
+// copied into a user buffer. The text is not terminated, parse it with an explicit length.
+class LitMappedFile {
+public:
+    LitMappedFile() = default;
+    LitMappedFile(const LitMappedFile&) = delete;
+    LitMappedFile& operator=(const LitMappedFile&) = delete;
+    ~LitMappedFile() { Close(); }
+
+    // false if the file can't be opened or mapped, an empty file maps to data() == "" and size() == 0
+    bool Open(const char* path);
+    void Close();
+
+    const char* data() const { return map != nullptr ? map : ""; }
+    size_t size() const { return len; }
+
+private:
+    const char* map = nullptr;
+    size_t len = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+#endif
@@ -0,0 +1,39 @@
+#include "LitMemory.h"
+
+#include <atomic>
+#include <cassert>
+#include <new>
+
+namespace {
+
+class LitNewDeleteResource : public LitMemoryResource {
+protected:
+    void* DoAllocate(size_t bytes, size_t) override { return ::operator new(bytes); }
+    void DoDeallocate(void* p, size_t, size_t) override { ::operator delete(p); }
+};
+
+}  // namespace
+
+LitMemoryResource* lit_get_new_delete_resource() {
+    static LitNewDeleteResource resource;
+    return &resource;
+}
+
+static std::atomic<LitMemoryResource*> lit_default_resource(nullptr);
+
+LitMemoryResource* lit_get_default_resource() {
+    LitMemoryResource* r = lit_default_resource.load(std::memory_order_acquire);
+    return r != nullptr ? r : lit_get_new_delete_resource();
+}
+
+LitMemoryResource* lit_set_default_resource(LitMemoryResource* resource) {
+    LitMemoryResource* old = lit_default_resource.exchange(resource, std::memory_order_acq_rel);
+    return old != nullptr ? old : lit_get_new_delete_resource();
+}
+
+void* LitMonotonicResource::DoAllocate(size_t bytes, size_t alignment) {
+    // the arena aligns every block for any scalar type
+    assert(alignment <= alignof(std::max_align_t));
+    (void)alignment;
+    return arena.Allocate(bytes);
+}
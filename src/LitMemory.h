@@ -0,0 +1,105 @@
+#ifndef LITMEMORY_H_
+#define LITMEMORY_H_
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include "LitArena.h"
+
+// Where LitValue trees get their memory, modelled on std::pmr::memory_resource (C++17) so the library stays C++11.
+// A LitJson constructed with a resource allocates every string, array and object it creates from it: parsed trees,
+// setter copies and LitCopy. Resources are not synchronized unless they say so, and must outlive every value
+// holding their memory.
+//
+// The one exception is the hash index of a large object (see LitJson::lit_find_object_index). It is a lookup cache
+// that const lookups on several threads may build at once, which an unsynchronized resource can't serve, so it
+// always comes from operator new and is freed with the object.
+class LitMemoryResource {
+public:
+    virtual ~LitMemoryResource() = default;
+
+    void* LitAllocate(size_t bytes, size_t alignment) { return DoAllocate(bytes, alignment); }
+    void LitDeallocate(void* p, size_t bytes, size_t alignment) { DoDeallocate(p, bytes, alignment); }
+    // memory from one can be freed through the other
+    bool LitIsEqual(const LitMemoryResource& other) const { return this == &other || DoIsEqual(other); }
+
+protected:
+    virtual void* DoAllocate(size_t bytes, size_t alignment) = 0;
+    virtual void DoDeallocate(void* p, size_t bytes, size_t alignment) = 0;
+    virtual bool DoIsEqual(const LitMemoryResource&) const { return false; }
+};
+
+// operator new and delete, thread-safe
+LitMemoryResource* lit_get_new_delete_resource();
+// the resource default-constructed allocators and LitJson use, new/delete until changed. Set it before values are
+// created, nullptr restores new/delete. Returns the previous one.
+LitMemoryResource* lit_get_default_resource();
+LitMemoryResource* lit_set_default_resource(LitMemoryResource* resource);
+
+// Bump allocation from a LitArena: freeing is a no-op and LitRelease drops everything at once, keeping the memory
+// for the next round. Meant for one resource per request or per thread.
+class LitMonotonicResource : public LitMemoryResource {
+public:
+    explicit LitMonotonicResource(size_t chunk_size = LitArena::kDefaultChunkSize) : arena(chunk_size) {}
+    LitMonotonicResource(const LitMonotonicResource&) = delete;
+    LitMonotonicResource& operator=(const LitMonotonicResource&) = delete;
+
+    // every value allocated from this resource must be gone
+    void LitRelease() { arena.Reset(); }
+    size_t lit_get_capacity() const { return arena.Capacity(); }
+    size_t lit_get_used() const { return arena.Used(); }
+
+protected:
+    void* DoAllocate(size_t bytes, size_t alignment) override;
+    void DoDeallocate(void*, size_t, size_t) override {}
+
+private:
+    LitArena arena;
+};
+
+// Standard allocator over a LitMemoryResource, like std::pmr::polymorphic_allocator: it is never propagated by
+// container assignment or swap, and a copied container gets the default resource, so a copy never ties itself to
+// a short-lived pool by accident. Moving a container keeps its memory where it is.
+template <typename T>
+class LitAllocator {
+public:
+    typedef T value_type;
+
+    LitAllocator() : resource(lit_get_default_resource()) {}
+    // implicit like std::pmr, so a resource can be passed wherever an allocator is expected
+    LitAllocator(LitMemoryResource* resource) : resource(resource) {}  // NOLINT
+    template <typename U>
+    LitAllocator(const LitAllocator<U>& a) : resource(a.lit_get_resource()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(resource->LitAllocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) { resource->LitDeallocate(p, n * sizeof(T), alignof(T)); }
+
+    LitAllocator select_on_container_copy_construction() const { return LitAllocator(); }
+    LitMemoryResource* lit_get_resource() const { return resource; }
+
+private:
+    LitMemoryResource* resource;
+};
+
+template <typename T, typename U>
+bool operator==(const LitAllocator<T>& a, const LitAllocator<U>& b) {
+    return a.lit_get_resource()->LitIsEqual(*b.lit_get_resource());
+}
+template <typename T, typename U>
+bool operator!=(const LitAllocator<T>& a, const LitAllocator<U>& b) {
+    return !(a == b);
+}
+
+// the strings of a LitValue
+typedef std::basic_string<char, std::char_traits<char>, LitAllocator<char>> LitString;
+
+// compare with std::string, which has no operator for strings of another allocator
+inline bool operator==(const LitString& a, const std::string& b) {
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size()) == 0;
+}
+inline bool operator==(const std::string& a, const LitString& b) { return b == a; }
+inline bool operator!=(const LitString& a, const std::string& b) { return !(a == b); }
+inline bool operator!=(const std::string& a, const LitString& b) { return !(b == a); }
+
+#endif
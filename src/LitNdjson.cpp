@@ -0,0 +1,123 @@
+#include "LitNdjson.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "LitDecode.h"
+#include "LitMappedFile.h"
+#include "LitShapeCache.h"
+
+// ranges small enough that every thread gets several of them, big enough that claiming one is noise
+static const size_t kMinRangeSize = 64 * 1024;
+static const size_t kMaxRangeSize = 1024 * 1024;
+
+LitNdjsonParser::LitNdjsonParser(unsigned threads) : threads(threads) {
+    if (this->threads == 0) this->threads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void LitNdjsonParser::LitParseRange(const char* text, size_t len, size_t begin, size_t end, const LitJson& lit,
+                                    LitShapeCache* cache, std::vector<LitNdjsonRecord>* out) {
+    size_t pos = begin;
+    // a line belongs to the range its first byte is in
+    if (pos > 0 && text[pos - 1] != '\n') {
+        const char* nl = static_cast<const char*>(memchr(text + pos, '\n', len - pos));
+        if (nl == nullptr) return;
+        pos = nl - text + 1;
+    }
+    while (pos < end) {
+        const char* nl = static_cast<const char*>(memchr(text + pos, '\n', len - pos));
+        size_t stop = nl != nullptr ? nl - text : len;
+        size_t i = pos;
+        while (i < stop && LitIsWhitespace(text[i])) ++i;
+        // blank lines are not records
+        if (i < stop) {
+            out->emplace_back();
+            LitNdjsonRecord& r = out->back();
+            r.offset = pos;
+            r.length = stop - pos;
+            r.result = lit.LitParse(&r.value, text + pos, stop - pos, cache);
+        }
+        pos = stop + 1;
+    }
+}
+
+ParseResultType LitNdjsonParser::LitParse(const char* text, size_t len, const Callback& callback) {
+    assert(text != nullptr || len == 0);
+    size_t range = std::min(kMaxRangeSize, std::max(kMinRangeSize, len / (threads * 8)));
+    size_t count = (len + range - 1) / range;
+
+    std::vector<std::vector<LitNdjsonRecord>> results(count);
+    std::vector<char> done(count, 0);
+    std::atomic<size_t> next(0);
+    std::atomic<bool> stop(false);
+
+    // whoever finishes the next range in order delivers it, and every finished range after it, while the others
+    // go on parsing. done, deliver and delivering are guarded by mutex.
+    std::mutex mutex;
+    size_t deliver = 0;
+    bool delivering = false;
+
+    // LitJson is stateless, all workers share it
+    const LitJson lit;
+    auto work = [&]() {
+        // records tend to share their keys, each worker learns them in its own cache
+        LitShapeCache cache;
+        while (!stop.load(std::memory_order_relaxed)) {
+            size_t r = next.fetch_add(1, std::memory_order_relaxed);
+            if (r >= count) break;
+            LitParseRange(text, len, r * range, std::min(len, (r + 1) * range), lit, &cache, &results[r]);
+
+            std::unique_lock<std::mutex> lock(mutex);
+            done[r] = 1;
+            if (delivering) continue;
+            delivering = true;
+            while (deliver < count && done[deliver] && !stop.load(std::memory_order_relaxed)) {
+                std::vector<LitNdjsonRecord> records(std::move(results[deliver++]));
+                lock.unlock();
+                for (LitNdjsonRecord& record : records) {
+                    if (!callback(&record)) {
+                        stop.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+                lock.lock();
+            }
+            delivering = false;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    size_t helpers = std::min<size_t>(threads, count) - (count > 0 ? 1 : 0);
+    for (size_t i = 0; i < helpers; ++i) pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool) t.join();
+
+    return stop ? LIT_PARSE_TERMINATED : LIT_PARSE_OK;
+}
+
+ParseResultType LitNdjsonParser::LitParse(const char* text, size_t len, std::vector<LitNdjsonRecord>* records) {
+    assert(records != nullptr);
+    records->clear();
+    return LitParse(text, len, [records](LitNdjsonRecord* record) {
+        records->push_back(std::move(*record));
+        return true;
+    });
+}
+
+ParseResultType LitNdjsonParser::LitParseFile(const char* path, const Callback& callback) {
+    LitMappedFile file;
+    if (!file.Open(path)) return LIT_PARSE_FILE_ERROR;
+    return LitParse(file.data(), file.size(), callback);
+}
+
+ParseResultType LitNdjsonParser::LitParseFile(const char* path, std::vector<LitNdjsonRecord>* records) {
+    assert(records != nullptr);
+    records->clear();
+    LitMappedFile file;
+    if (!file.Open(path)) return LIT_PARSE_FILE_ERROR;
+    return LitParse(file.data(), file.size(), records);
+}
@@ -0,0 +1,51 @@
+#ifndef LITNDJSON_H_
+#define LITNDJSON_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "LitJson.h"
+#include "LitValue.h"
+
+// one line of a newline-delimited text
+struct LitNdjsonRecord {
+    ParseResultType result = LIT_PARSE_OK;  // the value is null unless this is LIT_PARSE_OK
+    size_t offset = 0;                      // where the line starts in the text
+    size_t length = 0;                      // without the '\n'
+    LitValue value;
+};
+
+// Parallel parser for NDJSON / JSON Lines: every non-blank line is one JSON text, a line may end in "\r\n".
+//
+// The text is cut into byte ranges that worker threads claim one at a time from a shared counter, so a thread
+// that got cheap lines simply claims more ranges. Each worker finds the lines starting in its range with memchr
+// and parses them with one shared LitJson, so the only shared state is the counter and the hand-over of results.
+class LitNdjsonParser {
+public:
+    // receives the records in input order, calls never overlap. Returning false stops the batch: records not
+    // yet delivered are dropped and the parse returns LIT_PARSE_TERMINATED.
+    typedef std::function<bool(LitNdjsonRecord* record)> Callback;
+
+    // threads == 0 uses one per hardware thread, the calling thread is one of them
+    explicit LitNdjsonParser(unsigned threads = 0);
+
+    // parse all records into records (replacing its content), in input order
+    ParseResultType LitParse(const char* text, size_t len, std::vector<LitNdjsonRecord>* records);
+    // stream the records to callback
+    ParseResultType LitParse(const char* text, size_t len, const Callback& callback);
+    // same for a memory-mapped file, LIT_PARSE_FILE_ERROR if it can't be opened
+    ParseResultType LitParseFile(const char* path, std::vector<LitNdjsonRecord>* records);
+    ParseResultType LitParseFile(const char* path, const Callback& callback);
+
+    unsigned lit_get_threads() const { return threads; }
+
+private:
+    // parse the lines starting in [begin, end) of text, a line may run past end
+    static void LitParseRange(const char* text, size_t len, size_t begin, size_t end, const LitJson& lit,
+                              LitShapeCache* cache, std::vector<LitNdjsonRecord>* out);
+
+    unsigned threads;
+};
+
+#endif
@@ -0,0 +1,603 @@
+#include "LitNumber.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "LitPow10Table.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// powers of ten that are exact in a double
+static const double kExactPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static inline int LitCountLeadingZero(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    unsigned long i;
+    _BitScanReverse64(&i, x);
+    return 63 - static_cast<int>(i);
+#endif
+}
+
+static inline void LitMul128(uint64_t a, uint64_t b, uint64_t* hi, uint64_t* lo) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+    *hi = static_cast<uint64_t>(r >> 64);
+    *lo = static_cast<uint64_t>(r);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    *lo = _umul128(a, b, hi);
+#else
+    uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFF) + (hl & 0xFFFFFFFF);
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    *lo = (mid << 32) | (ll & 0xFFFFFFFF);
+#endif
+}
+
+static inline double LitBitsToDouble(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// Eisel-Lemire: man * 10^exp10 from one (rarely two) 64x64 bit products with a 128-bit approximation of the
+// power of ten. Gives up, returning false, whenever the approximation can't decide the rounding; man != 0.
+static bool LitEiselLemire(uint64_t man, int exp10, bool neg, double* d) {
+    if (exp10 < kLitPow10TableMinExp || exp10 > kLitPow10TableMaxExp) return false;
+    const uint64_t* pow10 = kLitPow10Table[exp10 - kLitPow10TableMinExp];
+
+    // normalization, 217706 / 2^16 approximates log2(10)
+    int clz = LitCountLeadingZero(man);
+    man <<= clz;
+    uint64_t exp2 = static_cast<uint64_t>(((217706 * exp10) >> 16) + 64 + 1023) - clz;
+
+    // multiplication
+    uint64_t x_hi, x_lo;
+    LitMul128(man, pow10[1], &x_hi, &x_lo);
+
+    // the low bits of the power of ten only matter when the product is right on the edge
+    if ((x_hi & 0x1FF) == 0x1FF && x_lo + man < man) {
+        uint64_t y_hi, y_lo;
+        LitMul128(man, pow10[0], &y_hi, &y_lo);
+        uint64_t merged_hi = x_hi, merged_lo = x_lo + y_hi;
+        if (merged_lo < x_lo) ++merged_hi;
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && y_lo + man < man) return false;
+        x_hi = merged_hi;
+        x_lo = merged_lo;
+    }
+
+    // shift to 54 bits
+    uint64_t msb = x_hi >> 63;
+    uint64_t ret = x_hi >> (msb + 9);
+    exp2 -= 1 ^ msb;
+
+    // halfway between two doubles, the truncated digits decide
+    if (x_lo == 0 && (x_hi & 0x1FF) == 0 && (ret & 3) == 1) return false;
+
+    // round to 53 bits
+    ret += ret & 1;
+    ret >>= 1;
+    if (ret >> 53 > 0) {
+        ret >>= 1;
+        ++exp2;
+    }
+
+    // exp2 is unsigned: 0 or wrapped around is subnormal, 0x7FF or above is infinity, leave both to the slow path
+    if (exp2 - 1 >= 0x7FF - 1) return false;
+
+    uint64_t bits = (exp2 << 52) | (ret & 0x000FFFFFFFFFFFFFULL);
+    if (neg) bits |= 0x8000000000000000ULL;
+    *d = LitBitsToDouble(bits);
+    return true;
+}
+
+// Exact fallback: arbitrary precision decimal (up to kMaxDigits digits, the rest only matters through trunc)
+// scaled by powers of two until it can be rounded to 53 bits.
+namespace {
+
+struct LitDecimal {
+    static const int kMaxDigits = 800;
+    static const int kMaxShift = 60;
+
+    void Assign(const char* first, const char* last);
+    void Shift(int k);
+    uint64_t RoundedInteger() const;
+    double ToDouble() const;
+
+    void LeftShift(int k);
+    void RightShift(int k);
+    void Trim();
+    bool ShouldRoundUp(int n) const;
+
+    char d[kMaxDigits];  // digits without the decimal point, value is 0.d[0..nd) * 10^dp
+    int nd = 0;
+    int dp = 0;
+    bool neg = false;
+    bool trunc = false;  // non-zero digits were dropped past kMaxDigits
+};
+
+void LitDecimal::Assign(const char* p, const char* last) {
+    if (*p == '-') {
+        neg = true;
+        ++p;
+    }
+    bool dot = false;
+    for (; p != last && ((*p >= '0' && *p <= '9') || *p == '.'); ++p) {
+        if (*p == '.') {
+            dot = true;
+            dp = nd;
+            continue;
+        }
+        if (*p == '0' && nd == 0) {
+            // leading zero
+            --dp;
+            continue;
+        }
+        if (nd < kMaxDigits) {
+            d[nd++] = *p;
+        } else if (*p != '0') {
+            trunc = true;
+        }
+    }
+    if (!dot) dp = nd;
+    if (p != last && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool eneg = false;
+        if (*p == '-' || *p == '+') eneg = *p++ == '-';
+        int e = 0;
+        for (; p != last; ++p) {
+            if (e < 100000) e = e * 10 + (*p - '0');
+        }
+        dp += eneg ? -e : e;
+    }
+    Trim();
+}
+
+void LitDecimal::Trim() {
+    while (nd > 0 && d[nd - 1] == '0') --nd;
+    if (nd == 0) dp = 0;
+}
+
+void LitDecimal::RightShift(int k) {
+    int r = 0, w = 0;
+    uint64_t n = 0;
+    // pick up enough leading digits to cover the first shift
+    for (; n >> k == 0; ++r) {
+        if (r >= nd) {
+            if (n == 0) {
+                nd = 0;
+                return;
+            }
+            while (n >> k == 0) {
+                n *= 10;
+                ++r;
+            }
+            break;
+        }
+        n = n * 10 + (d[r] - '0');
+    }
+    dp -= r - 1;
+
+    uint64_t mask = (1ULL << k) - 1;
+    for (; r < nd; ++r) {
+        uint64_t dig = n >> k;
+        n &= mask;
+        d[w++] = static_cast<char>('0' + dig);
+        n = n * 10 + (d[r] - '0');
+    }
+    while (n > 0) {
+        uint64_t dig = n >> k;
+        n &= mask;
+        if (w < kMaxDigits) {
+            d[w++] = static_cast<char>('0' + dig);
+        } else if (dig > 0) {
+            trunc = true;
+        }
+        n *= 10;
+    }
+    nd = w;
+    Trim();
+}
+
+void LitDecimal::LeftShift(int k) {
+    // produce the digits right to left at the end of a scratch buffer, a shift of k <= 60 adds at most 19
+    char buff[kMaxDigits + 20];
+    int w = sizeof(buff);
+    uint64_t n = 0;
+    for (int r = nd - 1; r >= 0; --r) {
+        n += static_cast<uint64_t>(d[r] - '0') << k;
+        uint64_t quo = n / 10;
+        buff[--w] = static_cast<char>('0' + (n - 10 * quo));
+        n = quo;
+    }
+    while (n > 0) {
+        uint64_t quo = n / 10;
+        buff[--w] = static_cast<char>('0' + (n - 10 * quo));
+        n = quo;
+    }
+    int count = static_cast<int>(sizeof(buff)) - w;
+    dp += count - nd;
+    if (count > kMaxDigits) {
+        for (int i = w + kMaxDigits; i < static_cast<int>(sizeof(buff)); ++i) {
+            if (buff[i] != '0') trunc = true;
+        }
+        count = kMaxDigits;
+    }
+    memcpy(d, buff + w, count);
+    nd = count;
+    Trim();
+}
+
+void LitDecimal::Shift(int k) {
+    if (nd == 0) return;
+    if (k > 0) {
+        for (; k > kMaxShift; k -= kMaxShift) LeftShift(kMaxShift);
+        LeftShift(k);
+    } else if (k < 0) {
+        for (; k < -kMaxShift; k += kMaxShift) RightShift(kMaxShift);
+        RightShift(-k);
+    }
+}
+
+bool LitDecimal::ShouldRoundUp(int n) const {
+    if (n < 0 || n >= nd) return false;
+    if (d[n] == '5' && n + 1 == nd) {
+        // exactly halfway, round to even unless digits were dropped
+        if (trunc) return true;
+        return n > 0 && (d[n - 1] - '0') % 2 == 1;
+    }
+    return d[n] >= '5';
+}
+
+uint64_t LitDecimal::RoundedInteger() const {
+    if (dp > 20) return 0xFFFFFFFFFFFFFFFFULL;
+    int i = 0;
+    uint64_t n = 0;
+    for (; i < dp && i < nd; ++i) n = n * 10 + (d[i] - '0');
+    for (; i < dp; ++i) n *= 10;
+    if (ShouldRoundUp(dp)) ++n;
+    return n;
+}
+
+double LitDecimal::ToDouble() const {
+    static const int kPowTab[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+    static const int kPowTabSize = sizeof(kPowTab) / sizeof(kPowTab[0]);
+    const int kBias = -1023;
+    LitDecimal a = *this;
+    uint64_t man = 0;
+    int exp = 0;
+    bool overflow = false;
+
+    if (a.nd == 0 || a.dp < -330) {
+        // zero or underflow
+        exp = kBias;
+    } else if (a.dp > 310) {
+        overflow = true;
+    } else {
+        // scale by powers of two until the value is in [0.5, 1)
+        while (a.dp > 0) {
+            int n = a.dp >= kPowTabSize ? 27 : kPowTab[a.dp];
+            a.Shift(-n);
+            exp += n;
+        }
+        while (a.dp < 0 || (a.dp == 0 && a.d[0] < '5')) {
+            int n = -a.dp >= kPowTabSize ? 27 : kPowTab[-a.dp];
+            a.Shift(n);
+            exp -= n;
+        }
+        // the double's significand is in [1, 2)
+        --exp;
+        // below the smallest normal exponent the value becomes subnormal
+        if (exp < kBias + 1) {
+            int n = kBias + 1 - exp;
+            a.Shift(-n);
+            exp += n;
+        }
+        if (exp - kBias >= 0x7FF) {
+            overflow = true;
+        } else {
+            // take 53 bits, rounding may carry into a 54th
+            a.Shift(53);
+            man = a.RoundedInteger();
+            if (man == (2ULL << 52)) {
+                man >>= 1;
+                ++exp;
+                if (exp - kBias >= 0x7FF) overflow = true;
+            }
+            if ((man & (1ULL << 52)) == 0) exp = kBias;
+        }
+    }
+    if (overflow) {
+        man = 0;
+        exp = 0x7FF + kBias;
+    }
+
+    uint64_t bits = man & ((1ULL << 52) - 1);
+    bits |= static_cast<uint64_t>((exp - kBias) & 0x7FF) << 52;
+    if (a.neg) bits |= 0x8000000000000000ULL;
+    return LitBitsToDouble(bits);
+}
+
+}  // namespace
+
+double LitNumberToDouble(uint64_t man, int exp10, bool neg, bool truncated, const char* first, const char* last) {
+    if (man == 0) return neg ? -0.0 : 0.0;
+
+    // Clinger: both operands are exact doubles, so one correctly rounded operation gives the answer
+    if (!truncated && man <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+        double d = static_cast<double>(man);
+        d = exp10 < 0 ? d / kExactPow10[-exp10] : d * kExactPow10[exp10];
+        return neg ? -d : d;
+    }
+
+    double d;
+    if (LitEiselLemire(man, exp10, neg, &d)) {
+        if (!truncated) return d;
+        // the dropped digits put the value between man and man + 1, fine if both round the same
+        double up;
+        if (LitEiselLemire(man + 1, exp10, neg, &up) && up == d) return d;
+    }
+
+    LitDecimal decimal;
+    decimal.Assign(first, last);
+    return decimal.ToDouble();
+}
+
+// Grisu2 (Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers"): the digits are
+// generated with 64-bit integer arithmetic inside the rounding interval of the double, so they always read back
+// as the same double and are the shortest such digits in all but very rare cases.
+namespace {
+
+struct LitDiyFp {
+    LitDiyFp(uint64_t f, int e) : f(f), e(e) {}
+
+    explicit LitDiyFp(double d) {
+        uint64_t u;
+        memcpy(&u, &d, sizeof(u));
+        int biased_e = static_cast<int>((u >> 52) & 0x7FF);
+        uint64_t significand = u & kSignificandMask;
+        if (biased_e != 0) {
+            f = significand + kHiddenBit;
+            e = biased_e - kExponentBias;
+        } else {
+            f = significand;
+            e = 1 - kExponentBias;
+        }
+    }
+
+    LitDiyFp operator-(const LitDiyFp& rhs) const { return LitDiyFp(f - rhs.f, e); }
+
+    // the upper 64 bits of the product, rounded
+    LitDiyFp operator*(const LitDiyFp& rhs) const {
+        uint64_t hi, lo;
+        LitMul128(f, rhs.f, &hi, &lo);
+        if (lo >> 63) ++hi;
+        return LitDiyFp(hi, e + rhs.e + 64);
+    }
+
+    LitDiyFp Normalize() const {
+        int s = LitCountLeadingZero(f);
+        return LitDiyFp(f << s, e - s);
+    }
+
+    // boundaries m- and m+ of the rounding interval, both with the exponent of the normalized m+
+    void NormalizedBoundaries(LitDiyFp* minus, LitDiyFp* plus) const {
+        LitDiyFp pl = LitDiyFp((f << 1) + 1, e - 1).Normalize();
+        // the interval is asymmetric when the significand is a power of two
+        LitDiyFp mi = (f == kHiddenBit) ? LitDiyFp((f << 2) - 1, e - 2) : LitDiyFp((f << 1) - 1, e - 1);
+        mi.f <<= mi.e - pl.e;
+        mi.e = pl.e;
+        *plus = pl;
+        *minus = mi;
+    }
+
+    static const uint64_t kSignificandMask = 0x000FFFFFFFFFFFFFULL;
+    static const uint64_t kHiddenBit = 0x0010000000000000ULL;
+    static const int kExponentBias = 0x3FF + 52;
+
+    uint64_t f;
+    int e;
+};
+
+}  // namespace
+
+static const uint64_t kPow10U64[] = {1ULL,
+                                     10ULL,
+                                     100ULL,
+                                     1000ULL,
+                                     10000ULL,
+                                     100000ULL,
+                                     1000000ULL,
+                                     10000000ULL,
+                                     100000000ULL,
+                                     1000000000ULL,
+                                     10000000000ULL,
+                                     100000000000ULL,
+                                     1000000000000ULL,
+                                     10000000000000ULL,
+                                     100000000000000ULL,
+                                     1000000000000000ULL,
+                                     10000000000000000ULL,
+                                     100000000000000000ULL,
+                                     1000000000000000000ULL,
+                                     10000000000000000000ULL};
+
+// cached power c = 10^-K such that the exponent of c times a DiyFp with exponent e lands in [-60, -32]
+static LitDiyFp LitGetCachedPower(int e, int* K) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = static_cast<int>(dk);
+    if (dk - k > 0.0) ++k;
+    unsigned index = static_cast<unsigned>((k >> 3) + 1);
+    *K = -(-348 + static_cast<int>(index << 3));
+    return LitDiyFp(kLitCachedPowersF[index], kLitCachedPowersE[index]);
+}
+
+static inline int LitCountDecimalDigit32(uint32_t n) {
+    int count = 1;
+    while (count < 10 && n >= kPow10U64[count]) ++count;
+    return count;
+}
+
+// move the last digit towards w as long as the result stays inside the interval and gets closer to w
+static void LitGrisuRound(char* buff, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        --buff[len - 1];
+        rest += ten_kappa;
+    }
+}
+
+static void LitDigitGen(const LitDiyFp& W, const LitDiyFp& Mp, uint64_t delta, char* buff, int* len, int* K) {
+    const LitDiyFp one(1ULL << -Mp.e, Mp.e);
+    const LitDiyFp wp_w = Mp - W;
+    uint32_t p1 = static_cast<uint32_t>(Mp.f >> -one.e);
+    uint64_t p2 = Mp.f & (one.f - 1);
+    int kappa = LitCountDecimalDigit32(p1);
+    *len = 0;
+
+    // integral part
+    while (kappa > 0) {
+        uint32_t div = static_cast<uint32_t>(kPow10U64[kappa - 1]);
+        uint32_t d = p1 / div;
+        p1 %= div;
+        if (d != 0 || *len != 0) buff[(*len)++] = static_cast<char>('0' + d);
+        --kappa;
+        uint64_t rest = (static_cast<uint64_t>(p1) << -one.e) + p2;
+        if (rest <= delta) {
+            *K += kappa;
+            LitGrisuRound(buff, *len, delta, rest, kPow10U64[kappa] << -one.e, wp_w.f);
+            return;
+        }
+    }
+
+    // fractional part
+    while (true) {
+        p2 *= 10;
+        delta *= 10;
+        char d = static_cast<char>(p2 >> -one.e);
+        if (d != 0 || *len != 0) buff[(*len)++] = static_cast<char>('0' + d);
+        p2 &= one.f - 1;
+        --kappa;
+        if (p2 < delta) {
+            *K += kappa;
+            int index = -kappa;
+            LitGrisuRound(buff, *len, delta, p2, one.f, wp_w.f * (index < 20 ? kPow10U64[index] : 0));
+            return;
+        }
+    }
+}
+
+// digits of v (v > 0) into buff, the value is buff[0..len) * 10^K
+static void LitGrisu2(double v, char* buff, int* len, int* K) {
+    const LitDiyFp w(v);
+    LitDiyFp w_m(0, 0), w_p(0, 0);
+    w.NormalizedBoundaries(&w_m, &w_p);
+
+    const LitDiyFp c_mk = LitGetCachedPower(w_p.e, K);
+    const LitDiyFp W = w.Normalize() * c_mk;
+    LitDiyFp Wp = w_p * c_mk;
+    LitDiyFp Wm = w_m * c_mk;
+    // stay strictly inside the interval to make up for the rounding of the products
+    ++Wm.f;
+    --Wp.f;
+    LitDigitGen(W, Wp, Wp.f - Wm.f, buff, len, K);
+}
+
+static const char kLitDigitPairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+int LitFormatUint64(uint64_t u, char* buff) {
+    int n = 1;
+    for (uint64_t t = u; t >= 10; t /= 10) ++n;
+
+    // two digits per division, from the back
+    char* p = buff + n;
+    while (u >= 100) {
+        unsigned r = static_cast<unsigned>(u % 100) * 2;
+        u /= 100;
+        *--p = kLitDigitPairs[r + 1];
+        *--p = kLitDigitPairs[r];
+    }
+    if (u >= 10) {
+        *--p = kLitDigitPairs[u * 2 + 1];
+        *--p = kLitDigitPairs[u * 2];
+    } else {
+        *--p = static_cast<char>('0' + u);
+    }
+    return n;
+}
+
+int LitFormatInt64(int64_t i, char* buff) {
+    if (i >= 0) return LitFormatUint64(static_cast<uint64_t>(i), buff);
+    // negate in unsigned arithmetic, INT64_MIN has no positive counterpart
+    *buff = '-';
+    return 1 + LitFormatUint64(0 - static_cast<uint64_t>(i), buff + 1);
+}
+
+int LitFormatDouble(double d, char* buff) {
+    char* p = buff;
+    if (std::signbit(d)) {
+        *p++ = '-';
+        d = -d;
+    }
+    if (d == 0.0) {
+        *p++ = '0';
+        return static_cast<int>(p - buff);
+    }
+
+    // whole numbers that are exact in a double skip the digit generation
+    if (d < 9007199254740992.0 && d == static_cast<double>(static_cast<uint64_t>(d))) {
+        return static_cast<int>(p - buff) + LitFormatUint64(static_cast<uint64_t>(d), p);
+    }
+
+    char digits[32];
+    int len = 0, K = 0;
+    LitGrisu2(d, digits, &len, &K);
+    int exp10 = len + K - 1;  // exponent of the first digit
+
+    if (exp10 >= -4 && exp10 < 17) {
+        if (exp10 < 0) {
+            // 0.000ddd
+            *p++ = '0';
+            *p++ = '.';
+            for (int i = -1; i > exp10; --i) *p++ = '0';
+            memcpy(p, digits, len);
+            p += len;
+        } else if (len <= exp10 + 1) {
+            // ddd000
+            memcpy(p, digits, len);
+            p += len;
+            for (int i = len; i <= exp10; ++i) *p++ = '0';
+        } else {
+            // dd.ddd
+            memcpy(p, digits, exp10 + 1);
+            p += exp10 + 1;
+            *p++ = '.';
+            memcpy(p, digits + exp10 + 1, len - exp10 - 1);
+            p += len - exp10 - 1;
+        }
+    } else {
+        // d.ddde+XX
+        *p++ = digits[0];
+        if (len > 1) {
+            *p++ = '.';
+            memcpy(p, digits + 1, len - 1);
+            p += len - 1;
+        }
+        *p++ = 'e';
+        *p++ = exp10 < 0 ? '-' : '+';
+        unsigned e = exp10 < 0 ? -exp10 : exp10;
+        if (e >= 100) *p++ = static_cast<char>('0' + e / 100);
+        *p++ = static_cast<char>('0' + e / 10 % 10);
+        *p++ = static_cast<char>('0' + e % 10);
+    }
+    return static_cast<int>(p - buff);
+}
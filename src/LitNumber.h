@@ -0,0 +1,23 @@
+#ifndef LITNUMBER_H_
+#define LITNUMBER_H_
+
+#include <cstdint>
+
+// Correctly rounded (round half to even) decimal to double conversion, independent of the C locale.
+//
+// The caller has already validated the text [first, last) as a JSON number and split it into the value
+// man * 10^exp10, where man holds at most the first 19 significant digits. truncated tells that non-zero digits
+// were dropped after those 19. A result too large for a double comes back as +/-HUGE_VAL.
+double LitNumberToDouble(uint64_t man, int exp10, bool neg, bool truncated, const char* first, const char* last);
+
+// Shortest text that reads back as exactly d (d finite), written to buff, which needs room for 25 characters.
+// Returns the length, buff is not NUL-terminated. The layout follows printf("%.17g"): plain notation for decimal
+// exponents in [-4, 17) ("0.0001", "123.5", "-0"), scientific notation otherwise ("1e+20", "1.234e-20").
+int LitFormatDouble(double d, char* buff);
+
+// Decimal digits of an unsigned integer, written to buff, which needs room for 20 characters. Returns the length.
+int LitFormatUint64(uint64_t u, char* buff);
+// same for a signed integer, buff needs room for 20 characters
+int LitFormatInt64(int64_t i, char* buff);
+
+#endif
@@ -0,0 +1,47 @@
+#include "LitObjectIndex.h"
+
+#include <cstring>
+
+static inline uint64_t LitHashKey(const char* s, size_t len) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL ^ len;
+    for (; len >= 8; s += 8, len -= 8) {
+        uint64_t w;
+        memcpy(&w, s, 8);
+        h = (h ^ w) * 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 32;
+    }
+    uint64_t w = 0;
+    memcpy(&w, s, len);
+    h = (h ^ w) * 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+LitObjectIndex::LitObjectIndex(const LitValue::Obj& obj) {
+    // at most half full
+    size_t cap = 16;
+    while (cap < obj.size() * 2) cap <<= 1;
+    slots.assign(cap, Slot{0, 0});
+    mask = cap - 1;
+
+    for (size_t i = 0; i < obj.size(); ++i) {
+        const LitValue::String& key = obj[i].first;
+        uint32_t hash = static_cast<uint32_t>(LitHashKey(key.data(), key.size()));
+        size_t s = hash & mask;
+        for (; slots[s].pos != 0; s = (s + 1) & mask) {
+            // keep the first of duplicate keys
+            if (slots[s].hash == hash && obj[slots[s].pos - 1].first == key) break;
+        }
+        if (slots[s].pos == 0) slots[s] = Slot{hash, static_cast<uint32_t>(i + 1)};
+    }
+}
+
+size_t LitObjectIndex::Find(const LitValue::Obj& obj, const char* key, size_t len) const {
+    uint32_t hash = static_cast<uint32_t>(LitHashKey(key, len));
+    for (size_t s = hash & mask; slots[s].pos != 0; s = (s + 1) & mask) {
+        if (slots[s].hash != hash) continue;
+        const LitValue::String& k = obj[slots[s].pos - 1].first;
+        if (k.size() == len && memcmp(k.data(), key, len) == 0) return slots[s].pos - 1;
+    }
+    return LIT_KEY_NOT_EXIST;
+}
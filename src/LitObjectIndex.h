@@ -0,0 +1,32 @@
+#ifndef LITOBJECTINDEX_H_
+#define LITOBJECTINDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "LitValue.h"
+
+// Open addressing hash table over the keys of one LitValue::Obj. It only stores positions into the vector, so
+// the members keep their insertion order, and of duplicate keys the first one wins just like a linear scan.
+class LitObjectIndex {
+public:
+    // objects smaller than this are scanned, hashing the key costs more than a few compares
+    static const size_t kThreshold = 16;
+
+    explicit LitObjectIndex(const LitValue::Obj& obj);
+
+    // position of key in obj (the object the index was built from), LIT_KEY_NOT_EXIST if absent
+    size_t Find(const LitValue::Obj& obj, const char* key, size_t len) const;
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t pos;  // position + 1, 0 marks an empty slot
+    };
+
+    std::vector<Slot> slots;
+    size_t mask = 0;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "LitPointer.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "LitReader.h"
+
+// getters for LitFind, the matches LitExtract builds come from LitPointerHandler::lit
+static const LitJson view;
+
+bool LitPointer::LitCompile(const char* pointer) {
+    assert(pointer != nullptr);
+    return LitCompile(pointer, strlen(pointer));
+}
+
+bool LitPointer::LitCompile(const char* pointer, size_t len) {
+    assert(pointer != nullptr || len == 0);
+    tokens.clear();
+    compiled = wildcard = false;
+    if (len > 0 && pointer[0] != '/') return false;
+
+    const char* p = pointer;
+    const char* end = pointer + len;
+    while (p < end) {
+        // p is at the '/' that starts a token
+        ++p;
+        tokens.emplace_back();
+        Token& token = tokens.back();
+        for (; p < end && *p != '/'; ++p) {
+            if (*p != '~') {
+                token.key.push_back(*p);
+            } else if (p + 1 < end && (p[1] == '0' || p[1] == '1')) {
+                token.key.push_back(*++p == '0' ? '~' : '/');
+            } else {
+                tokens.clear();
+                return false;
+            }
+        }
+
+        token.wildcard = token.key == "*";
+        wildcard = wildcard || token.wildcard;
+        // an array index is "0" or digits without a leading zero, "-" (past the end) never matches
+        const std::string& k = token.key;
+        if (!k.empty() && k.size() <= 19 && k[0] >= '0' && k[0] <= '9' && (k[0] != '0' || k.size() == 1)) {
+            size_t index = 0;
+            size_t i = 0;
+            for (; i < k.size() && k[i] >= '0' && k[i] <= '9'; ++i) index = index * 10 + (k[i] - '0');
+            if (i == k.size()) token.index = index;
+        }
+    }
+    compiled = true;
+    return true;
+}
+
+template <typename Value, typename Sink>
+bool LitPointer::LitFindFrom(Value* v, size_t i, Sink* sink) const {
+    // descend while the tokens select a single child, branch at wildcards
+    for (; i < tokens.size(); ++i) {
+        const Token& token = tokens[i];
+        LitType type = view.lit_get_type(*v);
+        if (type == LIT_OBJECT) {
+            v = view.lit_find_object_value(*v, token.key.data(), token.key.size());
+            if (v == nullptr) return true;
+        } else if (type == LIT_ARRAY) {
+            size_t size = view.lit_get_array_size(*v);
+            if (token.wildcard) {
+                for (size_t j = 0; j < size; ++j) {
+                    if (!LitFindFrom(&view.lit_get_array_element(*v, j), i + 1, sink)) return false;
+                }
+                return true;
+            }
+            if (token.index >= size) return true;
+            v = &view.lit_get_array_element(*v, token.index);
+        } else {
+            return true;
+        }
+    }
+    return (*sink)(v);
+}
+
+const LitValue* LitPointer::LitFind(const LitValue& root) const {
+    const LitValue* res = nullptr;
+    auto first = [&res](const LitValue* v) {
+        res = v;
+        return false;
+    };
+    if (compiled) LitFindFrom(&root, 0, &first);
+    return res;
+}
+
+LitValue* LitPointer::LitFind(LitValue& root) const {
+    LitValue* res = nullptr;
+    auto first = [&res](LitValue* v) {
+        res = v;
+        return false;
+    };
+    if (compiled) LitFindFrom(&root, 0, &first);
+    return res;
+}
+
+void LitPointer::LitFindAll(const LitValue& root, std::vector<const LitValue*>* res) const {
+    assert(res != nullptr);
+    auto all = [res](const LitValue* v) {
+        res->push_back(v);
+        return true;
+    };
+    if (compiled) LitFindFrom(&root, 0, &all);
+}
+
+// Follows the position of every event against the pointer and builds a LitValue only for the matches. Outside a
+// match the handler keeps one small frame per open container and copies nothing.
+class LitPointerHandler {
+public:
+    LitPointerHandler(const LitPointer& pointer, std::vector<LitValue>* res) : pointer(pointer), res(res) {}
+
+    bool Null() {
+        if (!LitWanted()) return LitSkip();
+        LitValue v;
+        lit.lit_set_null(&v);
+        return LitScalar(&v);
+    }
+    bool Bool(bool b) {
+        if (!LitWanted()) return LitSkip();
+        LitValue v;
+        lit.lit_set_boolean(&v, b);
+        return LitScalar(&v);
+    }
+    bool Double(double d) {
+        if (!LitWanted()) return LitSkip();
+        LitValue v;
+        lit.lit_set_number(&v, d);
+        return LitScalar(&v);
+    }
+    bool Int64(int64_t i) {
+        if (!LitWanted()) return LitSkip();
+        LitValue v;
+        lit.lit_set_int64(&v, i);
+        return LitScalar(&v);
+    }
+    bool Uint64(uint64_t u) {
+        if (!LitWanted()) return LitSkip();
+        LitValue v;
+        lit.lit_set_uint64(&v, u);
+        return LitScalar(&v);
+    }
+    bool String(const char* str, size_t len) {
+        if (!LitWanted()) return LitSkip();
+        LitValue v;
+        lit.lit_set_string(&v, str, len);
+        return LitScalar(&v);
+    }
+    bool Key(const char* str, size_t len) {
+        if (!builds.empty()) {
+            builds.back().key.assign(str, len);
+            return true;
+        }
+        // a frame on the path is never deeper than the pointer, its children are selected by the next token. Of
+        // duplicate keys only the first matches, like in lit_find_object_value.
+        Frame& f = frames.back();
+        if (f.on_path) {
+            const std::string& key = pointer.tokens[frames.size() - 1].key;
+            f.key_match = !f.key_seen && key.size() == len && memcmp(key.data(), str, len) == 0;
+            f.key_seen = f.key_seen || f.key_match;
+        }
+        return true;
+    }
+    bool StartObject() { return LitStart(true); }
+    bool EndObject(size_t) { return LitEnd(); }
+    bool StartArray() { return LitStart(false); }
+    bool EndArray(size_t) { return LitEnd(); }
+
+private:
+    // a container outside of the matches
+    struct Frame {
+        bool object;
+        bool on_path;    // the pointer matches the path down to this container
+        bool key_match;  // the current member's key is the next token
+        bool key_seen;   // a member with that key came before
+        size_t index;    // the current element of an array
+    };
+    // a container inside a match that is being built
+    struct Build {
+        explicit Build(bool object) : object(object) {}
+
+        bool object;
+        LitValue::Array elements;
+        LitValue::Obj members;
+        LitValue::String key;
+    };
+
+    // whether the value starting now is (inside) a match
+    bool LitWanted() const { return !builds.empty() || LitAtMatch(); }
+    bool LitAtMatch() const { return frames.size() == pointer.tokens.size() && LitChildOnPath(); }
+    bool LitChildOnPath() const {
+        if (frames.empty()) return pointer.compiled;
+        const Frame& f = frames.back();
+        return f.on_path && (f.object ? f.key_match : pointer.LitMatchIndex(frames.size() - 1, f.index));
+    }
+    void LitEndChild() {
+        if (!frames.empty() && !frames.back().object) ++frames.back().index;
+    }
+    bool LitSkip() {
+        LitEndChild();
+        return true;
+    }
+
+    bool LitStart(bool object) {
+        if (LitWanted()) {
+            builds.emplace_back(object);
+        } else {
+            bool on_path = frames.size() < pointer.tokens.size() && LitChildOnPath();
+            frames.push_back(Frame{object, on_path, false, false, 0});
+        }
+        return true;
+    }
+    bool LitEnd() {
+        if (builds.empty()) {
+            frames.pop_back();
+            return LitSkip();
+        }
+        LitValue v;
+        if (builds.back().object) {
+            lit.lit_set_object(&v, std::move(builds.back().members));
+        } else {
+            lit.lit_set_array(&v, std::move(builds.back().elements));
+        }
+        builds.pop_back();
+        return LitScalar(&v);
+    }
+    // a complete value that is wanted: part of the match being built or a whole match
+    bool LitScalar(LitValue* v) {
+        if (!builds.empty()) {
+            Build& b = builds.back();
+            if (b.object) {
+                b.members.emplace_back(std::move(b.key), std::move(*v));
+            } else {
+                b.elements.push_back(std::move(*v));
+            }
+            return true;
+        }
+        LitEndChild();
+        res->push_back(std::move(*v));
+        // without wildcards there is nothing left to find
+        return pointer.wildcard;
+    }
+
+    // one per LitExtract, the matches come from the default resource of the moment
+    const LitJson lit;
+    const LitPointer& pointer;
+    std::vector<LitValue>* res;
+    std::vector<Frame> frames;
+    std::vector<Build> builds;
+};
+
+ParseResultType LitPointer::LitExtract(const char* json, std::vector<LitValue>* res) const {
+    assert(json != nullptr && res != nullptr);
+    size_t size = res->size();
+    LitPointerHandler handler(*this, res);
+    LitReader<LitPointerHandler> reader;
+    ParseResultType r = reader.LitParse(json, &handler);
+    if (r == LIT_PARSE_TERMINATED) r = LIT_PARSE_OK;
+    if (r != LIT_PARSE_OK) res->resize(size);
+    return r;
+}
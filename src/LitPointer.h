@@ -0,0 +1,61 @@
+#ifndef LITPOINTER_H_
+#define LITPOINTER_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "LitJson.h"
+#include "LitValue.h"
+
+// Compiled JSON Pointer (RFC 6901): "" is the whole text, "/a/0/b" the member "b" of element 0 of member "a",
+// "~0" and "~1" stand for '~' and '/' inside a token. A token that is exactly "*" matches every element of an
+// array, on an object it is still the key "*".
+//
+// LitCompile splits and unescapes the tokens once, evaluating a pointer afterwards only compares keys and
+// indices: object members are looked up with lit_find_object_index (hashed for large objects), array indices
+// were converted when compiling.
+class LitPointer {
+public:
+    LitPointer() = default;
+
+    // false, and the pointer matches nothing, if it neither is empty nor starts with '/' or has a '~' that is not
+    // followed by '0' or '1'
+    bool LitCompile(const char* pointer);
+    bool LitCompile(const char* pointer, size_t len);
+
+    // the first match in document order, nullptr if there is none
+    const LitValue* LitFind(const LitValue& root) const;
+    LitValue* LitFind(LitValue& root) const;
+    // every match in document order, appended to res
+    void LitFindAll(const LitValue& root, std::vector<const LitValue*>* res) const;
+
+    // Parse json with LitReader and build only the matching values, appended to res in document order. Nothing
+    // outside the matches is materialized. Without wildcards there is at most one match and the parse stops right
+    // after it, the rest of the text is not checked.
+    ParseResultType LitExtract(const char* json, std::vector<LitValue>* res) const;
+
+    bool lit_is_compiled() const { return compiled; }
+    bool lit_has_wildcard() const { return wildcard; }
+
+private:
+    friend class LitPointerHandler;
+
+    struct Token {
+        std::string key;
+        size_t index = LIT_KEY_NOT_EXIST;  // the token as an array index, LIT_KEY_NOT_EXIST if it is none
+        bool wildcard = false;
+    };
+
+    // whether token i selects element index of an array
+    bool LitMatchIndex(size_t i, size_t index) const { return tokens[i].wildcard || tokens[i].index == index; }
+    // hand the matches of tokens[i..] below v to sink, stop when it returns false (and return false)
+    template <typename Value, typename Sink>
+    bool LitFindFrom(Value* v, size_t i, Sink* sink) const;
+
+    std::vector<Token> tokens;
+    bool compiled = false;
+    bool wildcard = false;
+};
+
+#endif
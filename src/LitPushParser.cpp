@@ -0,0 +1,295 @@
+#include "LitPushParser.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+#include "LitDecode.h"
+
+ParseResultType LitPushParser::Feed(const char* data, size_t len) {
+    assert(data != nullptr || len == 0);
+    const char* p = data;
+    const char* end = data + len;
+    while (p < end && error == LIT_PARSE_OK) {
+        switch (state) {
+            case STATE_STRING: p = LitFeedString(p, end); break;
+            case STATE_NUMBER: p = LitFeedNumber(p, end); break;
+            case STATE_LITERAL: p = LitFeedLiteral(p, end); break;
+            default: p = LitFeedStructural(p, end);
+        }
+    }
+    return error;
+}
+
+ParseResultType LitPushParser::Finish(LitValue* v) {
+    assert(v != nullptr);
+    // the end of the text terminates a pending token like the '\0' of LitParse
+    if (error == LIT_PARSE_OK) {
+        switch (state) {
+            case STATE_STRING: LitEndString(token.c_str()); break;
+            case STATE_NUMBER: LitEndNumber(token.c_str(), token.c_str() + token.size()); break;
+            case STATE_LITERAL: error = LIT_PARSE_INVALID_VALUE; break;
+            // between tokens, nothing is pending
+            default: break;
+        }
+    }
+    if (error == LIT_PARSE_OK) {
+        switch (state) {
+            case STATE_VALUE:
+            case STATE_ARRAY_FIRST: error = LIT_PARSE_EXPECT_VALUE; break;
+            case STATE_OBJECT_FIRST:
+            case STATE_OBJECT_KEY: error = LIT_PARSE_MISS_KEY; break;
+            case STATE_COLON: error = LIT_PARSE_MISS_COLON; break;
+            case STATE_AFTER_VALUE:
+                if (!stack.empty()) {
+                    error = stack.back().object ? LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET
+                                                : LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                }
+                break;
+            // a token still open was ended by the switch above, which moved the state past it or set error
+            default: break;
+        }
+    }
+
+    ParseResultType res = error;
+    if (res == LIT_PARSE_OK) {
+        *v = std::move(root);
+    } else {
+        lit.lit_set_null(v);
+    }
+    Reset();
+    return res;
+}
+
+void LitPushParser::Reset() {
+    lit.lit_set_null(&root);
+    stack.clear();
+    state = STATE_VALUE;
+    error = LIT_PARSE_OK;
+    token.clear();
+    escaped = false;
+}
+
+const char* LitPushParser::LitFeedStructural(const char* p, const char* end) {
+    while (p < end && LitIsWhitespace(*p)) ++p;
+    if (p == end) return p;
+
+    char ch = *p;
+    switch (state) {
+        case STATE_ARRAY_FIRST:
+            if (ch == ']') {
+                LitEndContainer();
+                return p + 1;
+            }
+            return LitFeedValue(p);
+        case STATE_VALUE: return LitFeedValue(p);
+        case STATE_OBJECT_FIRST:
+            if (ch == '}') {
+                LitEndContainer();
+                return p + 1;
+            }
+            // fall through
+        case STATE_OBJECT_KEY:
+            if (ch != '\"') {
+                error = LIT_PARSE_MISS_KEY;
+                return p;
+            }
+            key = true;
+            state = STATE_STRING;
+            return p;
+        case STATE_COLON:
+            if (ch != ':') {
+                error = LIT_PARSE_MISS_COLON;
+                return p;
+            }
+            state = STATE_VALUE;
+            return p + 1;
+        case STATE_AFTER_VALUE:
+            if (stack.empty()) {
+                error = LIT_PARSE_ROOT_NOT_SINGULAR;
+            } else if (stack.back().object) {
+                if (ch == ',') {
+                    state = STATE_OBJECT_KEY;
+                } else if (ch == '}') {
+                    LitEndContainer();
+                } else {
+                    error = LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+                }
+            } else {
+                if (ch == ',') {
+                    state = STATE_VALUE;
+                } else if (ch == ']') {
+                    LitEndContainer();
+                } else {
+                    error = LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                }
+            }
+            return error == LIT_PARSE_OK ? p + 1 : p;
+        default: assert(false); return p;
+    }
+}
+
+const char* LitPushParser::LitFeedValue(const char* p) {
+    switch (*p) {
+        case 'n':
+            literal = "null";
+            literal_type = LIT_NULL;
+            break;
+        case 't':
+            literal = "true";
+            literal_type = LIT_TRUE;
+            break;
+        case 'f':
+            literal = "false";
+            literal_type = LIT_FALSE;
+            break;
+        case '\"':
+            key = false;
+            state = STATE_STRING;
+            return p;
+        case '\0':
+            // like in LitParse, where it also stands for the end of the text
+            error = LIT_PARSE_EXPECT_VALUE;
+            return p;
+        case '[':
+        case '{':
+            if (stack.size() >= lit.lit_get_max_depth()) {
+                error = LIT_PARSE_DEPTH_EXCEEDED;
+                return p;
+            }
+            stack.emplace_back(*p == '{');
+            state = *p == '{' ? STATE_OBJECT_FIRST : STATE_ARRAY_FIRST;
+            return p + 1;
+        default:
+            // LitDecodeNumber reports whatever can't start a number
+            state = STATE_NUMBER;
+            return p;
+    }
+    literal_pos = 0;
+    state = STATE_LITERAL;
+    return p;
+}
+
+const char* LitPushParser::LitFeedString(const char* p, const char* end) {
+    // find the closing quote: a quote is escaped when an odd run of backslashes precedes it
+    const char* q = token.empty() ? p + 1 : p;
+    while (true) {
+        if (escaped) {
+            if (q == end) break;
+            ++q;
+            escaped = false;
+        }
+        const char* s = static_cast<const char*>(memchr(q, '\"', end - q));
+        const char* x = s != nullptr ? s : end;
+        size_t run = 0;
+        while (x - run > q && x[-1 - static_cast<ptrdiff_t>(run)] == '\\') ++run;
+        if (s == nullptr) {
+            escaped = run & 1;
+            break;
+        }
+        if (run & 1) {
+            q = s + 1;
+            continue;
+        }
+
+        // the string is complete, decode it from the chunk unless its start was buffered
+        if (token.empty()) {
+            LitEndString(p);
+        } else {
+            token.append(p, s + 1);
+            LitEndString(token.c_str());
+            token.clear();
+        }
+        return s + 1;
+    }
+    token.append(p, end);
+    return end;
+}
+
+const char* LitPushParser::LitFeedNumber(const char* p, const char* end) {
+    const char* q = p;
+    while (q < end && LitIsNumberChar(*q)) ++q;
+    if (q == end) {
+        // the next chunk may continue it
+        token.append(p, q);
+        return q;
+    }
+    if (token.empty()) {
+        LitEndNumber(p, q);
+    } else {
+        token.append(p, q);
+        LitEndNumber(token.c_str(), token.c_str() + token.size());
+        token.clear();
+    }
+    return q;
+}
+
+const char* LitPushParser::LitFeedLiteral(const char* p, const char* end) {
+    for (; p < end && literal[literal_pos] != '\0'; ++p, ++literal_pos) {
+        if (*p != literal[literal_pos]) {
+            error = LIT_PARSE_INVALID_VALUE;
+            return p;
+        }
+    }
+    if (literal[literal_pos] == '\0') {
+        LitValue v;
+        if (literal_type == LIT_NULL) {
+            lit.lit_set_null(&v);
+        } else {
+            lit.lit_set_boolean(&v, literal_type == LIT_TRUE);
+        }
+        LitEndValue(&v);
+    }
+    return p;
+}
+
+void LitPushParser::LitEndString(const char* first) {
+    // decoded straight into the value's buffer, keys and strings are moved in without a copy
+    LitValue::String s(lit.lit_get_resource());
+    if ((error = LitDecodeString(&first, &s)) != LIT_PARSE_OK) return;
+    if (key) {
+        stack.back().members.emplace_back(std::move(s), LitValue());
+        state = STATE_COLON;
+    } else {
+        LitValue v;
+        lit.lit_set_string(&v, std::move(s));
+        LitEndValue(&v);
+    }
+}
+
+void LitPushParser::LitEndNumber(const char* first, const char* last) {
+    const char* c = first;
+    LitDecodedNumber num;
+    if ((error = LitDecodeNumber(&c, &num)) != LIT_PARSE_OK) return;
+    LitValue v;
+    switch (num.type) {
+        case LIT_NUMBER_DOUBLE: lit.lit_set_number(&v, num.d); break;
+        case LIT_NUMBER_INT64: lit.lit_set_int64(&v, num.i); break;
+        case LIT_NUMBER_UINT64: lit.lit_set_uint64(&v, num.u); break;
+    }
+    LitEndValue(&v);
+    // e.g. "0123" or "1e5e5", what is left can't follow a value and reports the same error as LitParse
+    if (c != last) LitFeedStructural(c, last);
+}
+
+void LitPushParser::LitEndValue(LitValue* value) {
+    if (stack.empty()) {
+        root = std::move(*value);
+    } else if (stack.back().object) {
+        stack.back().members.back().second = std::move(*value);
+    } else {
+        stack.back().elements.push_back(std::move(*value));
+    }
+    state = STATE_AFTER_VALUE;
+}
+
+void LitPushParser::LitEndContainer() {
+    LitValue v;
+    if (stack.back().object) {
+        lit.lit_set_object(&v, std::move(stack.back().members));
+    } else {
+        lit.lit_set_array(&v, std::move(stack.back().elements));
+    }
+    stack.pop_back();
+    LitEndValue(&v);
+}
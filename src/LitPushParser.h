@@ -0,0 +1,86 @@
+#ifndef LITPUSHPARSER_H_
+#define LITPUSHPARSER_H_
+
+#include <string>
+#include <vector>
+
+#include "LitJson.h"
+#include "LitValue.h"
+
+// Incremental parser for text that arrives in pieces. Feed takes the chunks in order, each may end anywhere,
+// even inside a string, a number or a \u escape, and Finish marks the end of the text and hands over the value.
+// Tokens that lie inside one chunk are decoded straight from it, only a token cut by a chunk boundary is copied.
+//
+// The result and the error codes are the same as the bounded LitJson::LitParse(v, json, len) on the concatenated
+// text: the text is delimited by Finish, and a '\0' byte fails like the end of the text where it stands, so one in
+// a string is LIT_PARSE_MISS_QUOTATION_MARK and one in place of a value LIT_PARSE_EXPECT_VALUE.
+class LitPushParser {
+public:
+    LitPushParser() = default;
+    LitPushParser(const LitPushParser&) = delete;
+    LitPushParser& operator=(const LitPushParser&) = delete;
+
+    // returns the first error as soon as the text can no longer become valid JSON, later calls keep returning it
+    ParseResultType Feed(const char* data, size_t len);
+    // end of the text, on success moves the value into v, on error v is set to null. The parser is ready for the
+    // next text afterwards.
+    ParseResultType Finish(LitValue* v);
+    // drop a partially parsed text
+    void Reset();
+
+    // arrays and objects nested deeper fail with LIT_PARSE_DEPTH_EXCEEDED like in LitJson::LitParse, the value
+    // handed over is bounded the same way
+    size_t lit_get_max_depth() const { return lit.lit_get_max_depth(); }
+    void lit_set_max_depth(size_t depth) { lit.lit_set_max_depth(depth); }
+
+private:
+    enum State {
+        STATE_VALUE,         // a value must follow
+        STATE_ARRAY_FIRST,   // after '[', a value or ']'
+        STATE_OBJECT_FIRST,  // after '{', a key or '}'
+        STATE_OBJECT_KEY,    // after ',' in an object
+        STATE_COLON,         // after a key
+        STATE_AFTER_VALUE,   // ',' or the closing bracket, or the end of the text at the root
+        STATE_STRING,        // inside a string or key
+        STATE_NUMBER,        // inside a number
+        STATE_LITERAL        // inside null, true or false
+    };
+
+    // an array or object that is still open
+    struct Frame {
+        explicit Frame(bool object) : object(object) {}
+
+        bool object;
+        LitValue::Array elements;
+        LitValue::Obj members;
+    };
+
+    // each consumes from [p, end) and returns where it stopped, errors are left in error
+    const char* LitFeedStructural(const char* p, const char* end);
+    const char* LitFeedValue(const char* p);
+    const char* LitFeedString(const char* p, const char* end);
+    const char* LitFeedNumber(const char* p, const char* end);
+    const char* LitFeedLiteral(const char* p, const char* end);
+
+    // the whole token is in [first, last) and *last is a character that can't continue it (or '\0')
+    void LitEndString(const char* first);
+    void LitEndNumber(const char* first, const char* last);
+    void LitEndValue(LitValue* value);
+    void LitEndContainer();
+
+    LitJson lit;
+    LitValue root;
+    std::vector<Frame> stack;
+    State state = STATE_VALUE;
+    ParseResultType error = LIT_PARSE_OK;
+
+    // the part of a token seen so far when it is cut by a chunk boundary
+    std::string token;
+    bool key = false;      // the string is an object key
+    bool escaped = false;  // the string so far ends with an unpaired backslash
+    const char* literal = nullptr;
+    size_t literal_pos = 0;
+    LitType literal_type = LIT_NULL;
+};
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef LITREADER_H_
+#define LITREADER_H_
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+#include "LitDecode.h"
+#include "LitJson.h"
+
+// Event-driven (SAX) parser. It walks the same grammar as LitJson::LitParse and reports the same errors, but
+// instead of building a LitValue tree it calls the handler for every token, in document order:
+//
+//     bool Null();
+//     bool Bool(bool b);
+//     bool Double(double d);                    // numbers are split like LitNumberType
+//     bool Int64(int64_t i);
+//     bool Uint64(uint64_t u);
+//     bool String(const char* str, size_t len);  // not NUL-terminated, only valid during the call
+//     bool Key(const char* str, size_t len);     // same
+//     bool StartObject();
+//     bool EndObject(size_t member_count);
+//     bool StartArray();
+//     bool EndArray(size_t element_count);
+//
+// Returning false stops the parse with LIT_PARSE_TERMINATED. Memory does not grow with the text, only with the
+// nesting depth and the longest string that has escapes, so arbitrarily large texts can be streamed. Events are
+// emitted as soon as a token is read, a text that turns out to be invalid has already produced the events before
+// the error.
+template <typename Handler>
+class LitReader {
+public:
+    ParseResultType LitParse(const char* json, Handler* handler);
+
+    // arrays and objects nested deeper fail with LIT_PARSE_DEPTH_EXCEEDED before their Start event, like in LitJson
+    size_t lit_get_max_depth() const { return max_depth; }
+    void lit_set_max_depth(size_t depth) { max_depth = depth; }
+
+private:
+    void LitParseWhitespace();
+    ParseResultType LitParseLiteral(const char* literal, LitType type);
+    ParseResultType LitParseValue();
+    ParseResultType LitParseNumber();
+    ParseResultType LitParseString(bool key);
+    ParseResultType LitParseArray();
+    ParseResultType LitParseObject();
+
+    Handler* handler = nullptr;
+    const char* cur = nullptr;
+    std::string buff;  // decoded strings with escapes, reused across strings and parses
+    size_t depth = 0;  // containers the parser is inside of
+    size_t max_depth = LitJson::kDefaultMaxDepth;
+};
+
+// Handler with every event accepted and ignored, derive from it and declare only the events you need
+struct LitBaseHandler {
+    bool Null() { return true; }
+    bool Bool(bool) { return true; }
+    bool Double(double) { return true; }
+    bool Int64(int64_t) { return true; }
+    bool Uint64(uint64_t) { return true; }
+    bool String(const char*, size_t) { return true; }
+    bool Key(const char*, size_t) { return true; }
+    bool StartObject() { return true; }
+    bool EndObject(size_t) { return true; }
+    bool StartArray() { return true; }
+    bool EndArray(size_t) { return true; }
+};
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParse(const char* json, Handler* h) {
+    assert(json != nullptr && h != nullptr);
+    handler = h;
+    cur = json;
+    depth = 0;
+    LitParseWhitespace();
+    ParseResultType res = LitParseValue();
+    if (res == LIT_PARSE_OK) {
+        LitParseWhitespace();
+        if (*cur != '\0') res = LIT_PARSE_ROOT_NOT_SINGULAR;
+    }
+    return res;
+}
+
+template <typename Handler>
+void LitReader<Handler>::LitParseWhitespace() {
+    while (*cur == ' ' || *cur == '\t' || *cur == '\n' || *cur == '\r') ++cur;
+}
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParseLiteral(const char* literal, LitType type) {
+    assert(cur[0] == literal[0]);
+    size_t i = 1;
+    for (; literal[i] != '\0'; ++i) {
+        if (cur[i] != literal[i]) return LIT_PARSE_INVALID_VALUE;
+    }
+    cur += i;
+
+    bool go = type == LIT_NULL ? handler->Null() : handler->Bool(type == LIT_TRUE);
+    return go ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+}
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParseNumber() {
+    LitDecodedNumber num;
+    ParseResultType res;
+    if ((res = LitDecodeNumber(&cur, &num)) != LIT_PARSE_OK) return res;
+
+    bool go = true;
+    switch (num.type) {
+        case LIT_NUMBER_DOUBLE: go = handler->Double(num.d); break;
+        case LIT_NUMBER_INT64: go = handler->Int64(num.i); break;
+        case LIT_NUMBER_UINT64: go = handler->Uint64(num.u); break;
+    }
+    return go ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+}
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParseString(bool key) {
+    assert(*cur == '\"');
+    const char* str = cur + 1;
+    const char* q = LitScanString(str);
+    size_t len;
+    if (*q == '\"') {
+        // no escapes, hand out the text itself
+        len = q - str;
+        cur = q + 1;
+    } else {
+        ParseResultType res;
+        buff.clear();
+        if ((res = LitDecodeString(&cur, &buff)) != LIT_PARSE_OK) return res;
+        str = buff.data();
+        len = buff.size();
+    }
+
+    bool go = key ? handler->Key(str, len) : handler->String(str, len);
+    return go ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+}
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParseArray() {
+    assert(*cur == '[');
+    if (++depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+    ++cur;
+    if (!handler->StartArray()) return LIT_PARSE_TERMINATED;
+    LitParseWhitespace();
+    if (*cur == ']') {
+        ++cur;
+        --depth;
+        return handler->EndArray(0) ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+    }
+
+    size_t count = 0;
+    ParseResultType res;
+    while (true) {
+        if ((res = LitParseValue()) != LIT_PARSE_OK) return res;
+        ++count;
+        LitParseWhitespace();
+        if (*cur == ',') {
+            ++cur;
+            LitParseWhitespace();
+        } else if (*cur == ']') {
+            ++cur;
+            --depth;
+            return handler->EndArray(count) ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+        } else {
+            return LIT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        }
+    }
+}
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParseObject() {
+    assert(*cur == '{');
+    if (++depth > max_depth) return LIT_PARSE_DEPTH_EXCEEDED;
+    ++cur;
+    if (!handler->StartObject()) return LIT_PARSE_TERMINATED;
+    LitParseWhitespace();
+    if (*cur == '}') {
+        ++cur;
+        --depth;
+        return handler->EndObject(0) ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+    }
+
+    size_t count = 0;
+    ParseResultType res;
+    while (true) {
+        if (*cur != '\"') return LIT_PARSE_MISS_KEY;
+        if ((res = LitParseString(true)) != LIT_PARSE_OK) return res;
+        LitParseWhitespace();
+        if (*cur != ':') return LIT_PARSE_MISS_COLON;
+        ++cur;
+        LitParseWhitespace();
+        if ((res = LitParseValue()) != LIT_PARSE_OK) return res;
+        ++count;
+        LitParseWhitespace();
+        if (*cur == ',') {
+            ++cur;
+            LitParseWhitespace();
+        } else if (*cur == '}') {
+            ++cur;
+            --depth;
+            return handler->EndObject(count) ? LIT_PARSE_OK : LIT_PARSE_TERMINATED;
+        } else {
+            return LIT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        }
+    }
+}
+
+template <typename Handler>
+ParseResultType LitReader<Handler>::LitParseValue() {
+    switch (*cur) {
+        case 'n': return LitParseLiteral("null", LIT_NULL);
+        case 't': return LitParseLiteral("true", LIT_TRUE);
+        case 'f': return LitParseLiteral("false", LIT_FALSE);
+        case '\"': return LitParseString(false);
+        case '\0': return LIT_PARSE_EXPECT_VALUE;
+        case '[': return LitParseArray();
+        case '{': return LitParseObject();
+        default: return LitParseNumber();
+    }
+}
+
+#endif
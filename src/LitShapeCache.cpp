@@ -0,0 +1,45 @@
+#include "LitShapeCache.h"
+
+LitShapeCache::LitShapeCache() { LitClear(); }
+
+void LitShapeCache::LitClear() {
+    keys.clear();
+    key_ids.clear();
+    children.clear();
+    shapes.assign(1, Shape{kNone, kNone, kNone, 0});
+}
+
+uint32_t LitShapeCache::LitAdd(uint32_t outer, uint32_t shape, const char* text, size_t len) {
+    if (shape == kNone) return kNone;
+    uint32_t id;
+    std::string key(text, len);
+    auto k = key_ids.find(key);
+    if (k != key_ids.end()) {
+        id = k->second;
+    } else {
+        if (keys.size() >= kMaxKeys) return kNone;
+        bool plain = true;
+        for (unsigned char ch : key) plain = plain && ch >= 0x20 && ch != '\"' && ch != '\\';
+        id = static_cast<uint32_t>(keys.size());
+        keys.push_back(Key{key, plain});
+        key_ids.emplace(key, id);
+    }
+
+    uint64_t edge = static_cast<uint64_t>(shape) << 32 | id;
+    uint32_t child;
+    auto c = children.find(edge);
+    if (c != children.end()) {
+        child = c->second;
+    } else {
+        if (shapes.size() >= kMaxShapes) return kNone;
+        child = static_cast<uint32_t>(shapes.size());
+        shapes.push_back(Shape{id, kNone, kNone, 0});
+        children.emplace(edge, child);
+    }
+    if (shape != kEmpty) {
+        shapes[shape].next = child;
+    } else if (outer != kNone) {
+        shapes[outer].inner = child;
+    }
+    return child;
+}
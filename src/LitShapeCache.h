@@ -0,0 +1,79 @@
+#ifndef LITSHAPECACHE_H_
+#define LITSHAPECACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Keys and object shapes learned across parses, for texts full of records with the same keys in the same order.
+// Every key is stored once, and a shape is a path of keys in a trie whose nodes remember the key the last object
+// took next. The first key is remembered on the member the object is the value of (through arrays), so records
+// nested in different members are predicted apart. LitJson::LitParse with a cache checks the predicted key against
+// the raw text: on a hit it copies the stored key instead of decoding it, and an object whose first key is known
+// reserves its members once, with the size the last object starting there had.
+//
+// A cache is written by every parse that uses it, give each thread its own. It stops learning at kMaxKeys keys or
+// kMaxShapes shapes, objects it does not know are then parsed as without a cache.
+class LitShapeCache {
+    friend class LitJson;
+
+public:
+    static const uint32_t kMaxKeys = 1 << 16;
+    static const uint32_t kMaxShapes = 1 << 18;
+
+    LitShapeCache();
+
+    // forget every key and shape
+    void LitClear();
+
+    size_t lit_get_key_count() const { return keys.size(); }
+    // the empty shape included
+    size_t lit_get_shape_count() const { return shapes.size(); }
+
+private:
+    static const uint32_t kNone = static_cast<uint32_t>(-1);
+    static const uint32_t kEmpty = 0;  // the shape of an object before its first key
+
+    struct Key {
+        std::string text;
+        bool plain;  // no '"', '\\' or control character, so the text appears verbatim between quotes
+    };
+    struct Shape {
+        uint32_t key;      // the key this shape adds to its parent
+        uint32_t next;     // the shape the last object went on to from here, kNone if none did
+        uint32_t inner;    // the first shape of the last object in this member's value (kEmpty: the root's)
+        uint32_t members;  // for one-key shapes: the size of the last object that started with the key
+    };
+
+    // the shape the next key most likely leads to, from shape inside an object that is the value of member outer
+    uint32_t LitPredict(uint32_t outer, uint32_t shape) const {
+        if (shape != kEmpty) return shape != kNone ? shapes[shape].next : kNone;
+        return outer != kNone ? shapes[outer].inner : kNone;
+    }
+    // predicted if its key is the string at json (on the opening quote), kNone otherwise
+    uint32_t LitMatch(uint32_t predicted, const char* json, const char* end) const {
+        if (predicted == kNone) return kNone;
+        const Key& k = keys[shapes[predicted].key];
+        size_t len = k.text.size();
+        if (!k.plain || static_cast<size_t>(end - json) < len + 2 || json[len + 1] != '\"' ||
+            memcmp(json + 1, k.text.data(), len) != 0) {
+            return kNone;
+        }
+        return predicted;
+    }
+    // the shape after adding key to shape, learned if new and predicted from then on. kNone once the cache is
+    // full or for shape kNone.
+    uint32_t LitAdd(uint32_t outer, uint32_t shape, const char* key, size_t len);
+
+    const std::string& lit_get_key(uint32_t shape) const { return keys[shapes[shape].key].text; }
+
+    std::vector<Key> keys;
+    std::vector<Shape> shapes;
+    std::unordered_map<std::string, uint32_t> key_ids;
+    std::unordered_map<uint64_t, uint32_t> children;  // shape << 32 | key -> shape
+};
+
+#endif
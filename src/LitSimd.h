@@ -0,0 +1,57 @@
+#ifndef LITSIMD_H_
+#define LITSIMD_H_
+
+#include <cstdint>
+
+#include "LitDecode.h"
+
+// Instruction set support shared by the vectorized scanners. SSE2 is the x86-64 baseline, AVX2 code is compiled
+// with a target attribute and only called after a runtime check, so the library itself needs no -mavx2.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LIT_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(LIT_HAS_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define LIT_HAS_AVX2 1
+#include <immintrin.h>
+#define LIT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// The vector scanners read whole aligned blocks, which may start before p and run past the terminating '\0'.
+// An aligned block never crosses a page boundary so this is safe, but it is out of bounds as far as
+// AddressSanitizer and ThreadSanitizer are concerned.
+#if defined(__clang__) || defined(__GNUC__)
+#define LIT_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address, no_sanitize_thread))
+#else
+#define LIT_NO_SANITIZE_ADDRESS
+#endif
+
+inline LitSimdLevel LitDetectSimdLevel() {
+#ifdef LIT_HAS_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return LIT_SIMD_AVX2;
+#endif
+#ifdef LIT_HAS_SSE2
+    return LIT_SIMD_SSE2;
+#else
+    return LIT_SIMD_NONE;
+#endif
+}
+
+inline int LitCountTrailingZero(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return static_cast<int>(i);
+#endif
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include "LitSink.h"
+
+#include <cassert>
+#include <cerrno>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+LitBufferedSink::LitBufferedSink(size_t capacity) : buffer(capacity) {
+    assert(capacity > 0);
+    begin = pos = buffer.data();
+    limit = begin + capacity;
+}
+
+bool LitBufferedSink::LitFlush() {
+    if (ok && pos != begin && !LitWrite(begin, pos - begin)) ok = false;
+    // a failed sink keeps pos == limit, see LitSink::LitMakeRoom
+    pos = ok ? begin : limit;
+    return ok;
+}
+
+bool LitFileSink::LitWrite(const char* data, size_t len) {
+    return fwrite(data, 1, len, file) == len;
+}
+
+bool LitFdSink::LitWrite(const char* data, size_t len) {
+    while (len > 0) {
+#ifdef _WIN32
+        int n = _write(fd, data, static_cast<unsigned>(len < 0x40000000 ? len : 0x40000000));
+#else
+        ssize_t n = write(fd, data, len);
+#endif
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        len -= n;
+    }
+    return true;
+}
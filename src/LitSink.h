@@ -0,0 +1,139 @@
+#ifndef LITSINK_H_
+#define LITSINK_H_
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Output of LitJson::LitStringify. The text is collected in a fixed buffer that is handed on whenever it fills up,
+// so the memory used while stringifying does not grow with the document. After the first failed write the sink
+// drops everything and lit_is_ok() turns false.
+//
+// push_back and append are the Buffer interface of LitDecodeString, the stringifier writes to a sink and to a
+// std::string through the same template.
+class LitSink {
+public:
+    LitSink(const LitSink&) = delete;
+    LitSink& operator=(const LitSink&) = delete;
+    virtual ~LitSink() = default;
+
+    void push_back(char ch) {
+        if (pos == limit && !LitMakeRoom()) return;
+        *pos++ = ch;
+    }
+    void append(const char* s, size_t n) {
+        while (n > static_cast<size_t>(limit - pos)) {
+            size_t part = limit - pos;
+            memcpy(pos, s, part);
+            pos += part;
+            s += part;
+            n -= part;
+            if (!LitMakeRoom()) return;
+        }
+        memcpy(pos, s, n);
+        pos += n;
+    }
+
+    // hand what is buffered to the destination, false if anything was lost
+    virtual bool LitFlush() { return ok; }
+    bool lit_is_ok() const { return ok; }
+
+protected:
+    LitSink() = default;
+
+    // the buffer is full: pass it on and reset pos, false if that is not possible
+    virtual bool LitOverflow() = 0;
+
+    char* begin = nullptr;
+    char* pos = nullptr;
+    char* limit = nullptr;
+    bool ok = true;
+
+private:
+    bool LitMakeRoom() {
+        // a failed sink keeps pos == limit, so every later write ends up here
+        if (ok && !LitOverflow()) ok = false;
+        if (!ok) pos = limit;
+        return ok;
+    }
+};
+
+// Writes into memory the caller owns. Text past the end of the buffer is dropped and fails the sink.
+class LitBufferSink : public LitSink {
+public:
+    LitBufferSink(char* buffer, size_t capacity) {
+        begin = pos = buffer;
+        limit = buffer + capacity;
+    }
+
+    // bytes written, the text is not terminated
+    size_t lit_get_size() const { return pos - begin; }
+
+protected:
+    bool LitOverflow() override { return false; }
+};
+
+// Base of the sinks that own their buffer and pass every full buffer to LitWrite.
+class LitBufferedSink : public LitSink {
+public:
+    static const size_t kDefaultCapacity = 64 * 1024;
+
+    bool LitFlush() override;
+
+protected:
+    explicit LitBufferedSink(size_t capacity);
+
+    bool LitOverflow() override { return LitFlush(); }
+    // write all of [data, data + len) to the destination
+    virtual bool LitWrite(const char* data, size_t len) = 0;
+
+private:
+    std::vector<char> buffer;
+};
+
+// Writes with fwrite, the FILE* stays open and is not flushed.
+class LitFileSink : public LitBufferedSink {
+public:
+    explicit LitFileSink(FILE* file, size_t capacity = kDefaultCapacity) : LitBufferedSink(capacity), file(file) {}
+    ~LitFileSink() override { LitFlush(); }
+
+protected:
+    bool LitWrite(const char* data, size_t len) override;
+
+private:
+    FILE* file;
+};
+
+// Writes to a file descriptor, partial and interrupted writes are resumed. The descriptor stays open.
+class LitFdSink : public LitBufferedSink {
+public:
+    explicit LitFdSink(int fd, size_t capacity = kDefaultCapacity) : LitBufferedSink(capacity), fd(fd) {}
+    ~LitFdSink() override { LitFlush(); }
+
+protected:
+    bool LitWrite(const char* data, size_t len) override;
+
+private:
+    int fd;
+};
+
+// Passes every full buffer to a callback, which returns false to stop the stringify.
+class LitCallbackSink : public LitBufferedSink {
+public:
+    typedef std::function<bool(const char* data, size_t len)> Callback;
+
+    explicit LitCallbackSink(Callback callback, size_t capacity = kDefaultCapacity)
+        : LitBufferedSink(capacity), callback(std::move(callback)) {}
+    ~LitCallbackSink() override { LitFlush(); }
+
+protected:
+    bool LitWrite(const char* data, size_t len) override { return callback(data, len); }
+
+private:
+    Callback callback;
+};
+
+#endif
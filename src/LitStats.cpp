@@ -0,0 +1,43 @@
+#include "LitStats.h"
+
+#include <algorithm>
+
+void LitStats::LitAdd(const LitStats& s) {
+    parses += s.parses;
+    stringifies += s.stringifies;
+    bytes_scanned += s.bytes_scanned;
+    for (int i = 0; i < 7; ++i) values[i] += s.values[i];
+    max_depth = std::max(max_depth, s.max_depth);
+    strings_plain += s.strings_plain;
+    strings_escaped += s.strings_escaped;
+    allocations += s.allocations;
+    bytes_allocated += s.bytes_allocated;
+    number_ns += s.number_ns;
+    string_ns += s.string_ns;
+    bytes_written += s.bytes_written;
+    stringify_ns += s.stringify_ns;
+}
+
+static thread_local LitStats lit_thread_stats;
+static LitStatsCallback lit_stats_callback;
+
+bool lit_stats_enabled() {
+#ifdef LIT_ENABLE_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+LitStats lit_get_stats() { return lit_thread_stats; }
+
+void lit_reset_stats() { lit_thread_stats = LitStats(); }
+
+void lit_set_stats_callback(const LitStatsCallback& callback) { lit_stats_callback = callback; }
+
+#ifdef LIT_ENABLE_STATS
+void LitReportStats(const LitStats& s) {
+    lit_thread_stats.LitAdd(s);
+    if (lit_stats_callback) lit_stats_callback(s);
+}
+#endif
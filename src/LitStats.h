@@ -0,0 +1,73 @@
+#ifndef LITSTATS_H_
+#define LITSTATS_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+// Counters for LitJson::LitParse and LitJson::LitStringify, recorded only when the library is built with
+// LIT_ENABLE_STATS defined. Without it every hook compiles to nothing and the functions below report zeros.
+//
+// Each call counts into its own LitStats, which is then added to the calling thread's totals and handed to the
+// stats callback, so a server can tag the numbers with the endpoint that parsed. Timing reads the clock twice per
+// number and per string, expect a parse to be noticeably slower with the counters on.
+struct LitStats {
+    uint64_t parses = 0;
+    uint64_t stringifies = 0;
+
+    // parse
+    uint64_t bytes_scanned = 0;  // text handed to LitParse
+    uint64_t values[7] = {};     // parsed values by LitType, object keys not included
+    uint64_t max_depth = 0;      // deepest array / object nesting, 0 for a scalar root
+    uint64_t strings_plain = 0;  // strings and keys copied as is
+    uint64_t strings_escaped = 0;
+    // heap blocks the parser asked for building the tree: a container each time it grows, a string too long for
+    // the small string buffer once
+    uint64_t allocations = 0;
+    uint64_t bytes_allocated = 0;
+    uint64_t number_ns = 0;  // converting number text
+    uint64_t string_ns = 0;  // decoding strings and keys
+
+    // stringify
+    uint64_t bytes_written = 0;
+    uint64_t stringify_ns = 0;
+
+    void LitAdd(const LitStats& s);
+};
+
+typedef std::function<void(const LitStats&)> LitStatsCallback;
+
+// true in builds with LIT_ENABLE_STATS
+bool lit_stats_enabled();
+// the calling thread's totals since it started or last reset them
+LitStats lit_get_stats();
+void lit_reset_stats();
+// called on the parsing thread after every LitParse / LitStringify with that call's counters, nullptr to stop. Set
+// it before parsing starts, it is not synchronized with running parsers.
+void lit_set_stats_callback(const LitStatsCallback& callback);
+
+#ifdef LIT_ENABLE_STATS
+#define LIT_STATS_ONLY(statement) statement
+
+// add one call to the thread totals and run the callback
+void LitReportStats(const LitStats& s);
+
+// adds the nanoseconds between construction and destruction to *ns
+class LitStatsTimer {
+public:
+    explicit LitStatsTimer(uint64_t* ns) : ns(ns), start(std::chrono::steady_clock::now()) {}
+    ~LitStatsTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        *ns += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+private:
+    uint64_t* ns;
+    std::chrono::steady_clock::time_point start;
+};
+#else
+#define LIT_STATS_ONLY(statement)
+#endif
+
+#endif
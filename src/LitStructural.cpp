@@ -0,0 +1,155 @@
+#include "LitStructural.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "LitDecode.h"
+#include "LitSimd.h"
+
+// raw character classes of a 64 byte block, bit i is byte i
+struct LitBlockMasks {
+    uint64_t backslash;
+    uint64_t quote;
+    uint64_t whitespace;
+    uint64_t op;
+};
+
+static void LitClassifyScalar(const char* p, LitBlockMasks* m) {
+    m->backslash = m->quote = m->whitespace = m->op = 0;
+    for (int i = 0; i < 64; ++i) {
+        uint64_t bit = 1ULL << i;
+        switch (p[i]) {
+            case '\\': m->backslash |= bit; break;
+            case '\"': m->quote |= bit; break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r': m->whitespace |= bit; break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',': m->op |= bit; break;
+            default: break;
+        }
+    }
+}
+
+#ifdef LIT_HAS_SSE2
+static inline uint64_t LitEq16(__m128i x, char ch) {
+    return static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_set1_epi8(ch))));
+}
+
+static void LitClassifySSE2(const char* p, LitBlockMasks* m) {
+    m->backslash = m->quote = m->whitespace = m->op = 0;
+    for (int i = 0; i < 4; ++i) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i));
+        int shift = 16 * i;
+        m->backslash |= LitEq16(x, '\\') << shift;
+        m->quote |= LitEq16(x, '\"') << shift;
+        m->whitespace |= (LitEq16(x, ' ') | LitEq16(x, '\t') | LitEq16(x, '\n') | LitEq16(x, '\r')) << shift;
+        m->op |= (LitEq16(x, '{') | LitEq16(x, '}') | LitEq16(x, '[') | LitEq16(x, ']') | LitEq16(x, ':') |
+                  LitEq16(x, ','))
+                 << shift;
+    }
+}
+#endif
+
+#ifdef LIT_HAS_AVX2
+LIT_TARGET_AVX2 static inline uint64_t LitEq32(__m256i x, char ch) {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(ch))));
+}
+
+LIT_TARGET_AVX2 static void LitClassifyAVX2(const char* p, LitBlockMasks* m) {
+    m->backslash = m->quote = m->whitespace = m->op = 0;
+    for (int i = 0; i < 2; ++i) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32 * i));
+        int shift = 32 * i;
+        m->backslash |= LitEq32(x, '\\') << shift;
+        m->quote |= LitEq32(x, '\"') << shift;
+        m->whitespace |= (LitEq32(x, ' ') | LitEq32(x, '\t') | LitEq32(x, '\n') | LitEq32(x, '\r')) << shift;
+        m->op |= (LitEq32(x, '{') | LitEq32(x, '}') | LitEq32(x, '[') | LitEq32(x, ']') | LitEq32(x, ':') |
+                  LitEq32(x, ','))
+                 << shift;
+    }
+}
+#endif
+
+// bit i of the result is the xor of bits 0..i of x
+static inline uint64_t LitPrefixXor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+void LitBuildStructuralIndex(const char* json, size_t len, std::vector<uint32_t>* index) {
+    assert(json != nullptr && len < 0xFFFFFFFFu);
+    void (*classify)(const char*, LitBlockMasks*) = LitClassifyScalar;
+#ifdef LIT_HAS_SSE2
+    if (lit_get_simd_level() >= LIT_SIMD_SSE2) classify = LitClassifySSE2;
+#endif
+#ifdef LIT_HAS_AVX2
+    if (lit_get_simd_level() >= LIT_SIMD_AVX2) classify = LitClassifyAVX2;
+#endif
+
+    index->clear();
+    uint64_t prev_escaped = 0;  // 1 if the first byte of the block is escaped
+    uint64_t prev_inside = 0;   // all ones if the block starts inside a string
+    uint64_t prev_sep = 1;      // 1 if the byte before the block is whitespace or an operator
+    char tail[64];
+    for (size_t pos = 0; pos < len; pos += 64) {
+        const char* block = json + pos;
+        if (len - pos < 64) {
+            // pad the last block with whitespace, which never ends up in the index
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, block, len - pos);
+            block = tail;
+        }
+        LitBlockMasks m;
+        classify(block, &m);
+
+        // a backslash that is not itself escaped escapes the next byte
+        uint64_t escaped = 0;
+        uint64_t bs = m.backslash;
+        if (prev_escaped) {
+            escaped |= 1;
+            bs &= ~1ULL;
+        }
+        prev_escaped = 0;
+        while (bs != 0) {
+            int i = LitCountTrailingZero(bs);
+            bs &= bs - 1;
+            if (i == 63) {
+                prev_escaped = 1;
+            } else {
+                escaped |= 2ULL << i;
+                bs &= ~(2ULL << i);
+            }
+        }
+
+        // inside covers the opening quotation mark and the string body but not the closing quotation mark
+        uint64_t quote = m.quote & ~escaped;
+        uint64_t inside = LitPrefixXor(quote) ^ prev_inside;
+        prev_inside = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+
+        uint64_t sep = m.whitespace | m.op;
+        uint64_t follows_sep = (sep << 1) | prev_sep;
+        prev_sep = sep >> 63;
+
+        uint64_t op = m.op & ~inside;
+        uint64_t open_quote = quote & inside;
+        uint64_t scalar = ~(sep | m.quote) & ~inside & follows_sep;
+
+        uint64_t bits = op | open_quote | scalar;
+        while (bits != 0) {
+            index->push_back(static_cast<uint32_t>(pos + LitCountTrailingZero(bits)));
+            bits &= bits - 1;
+        }
+    }
+    index->push_back(static_cast<uint32_t>(len));
+}
@@ -0,0 +1,20 @@
+#ifndef LITSTRUCTURAL_H_
+#define LITSTRUCTURAL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Stage 1 of the indexed parse: record, in order, the offset of every character outside of strings that a parser
+// may have to stop at: the operators {}[]:, the opening quotation mark of each string and the first character of
+// every other run of non-whitespace (the start of a literal or number, or garbage). Escaped quotation marks are
+// accounted for. The offset of the terminator (len) is appended last.
+//
+// Any non-whitespace character outside of strings that follows whitespace is in the index, so a parser standing
+// on whitespace can jump straight to the next entry instead of skipping byte by byte.
+//
+// The classification runs 64 bytes at a time with SSE2 or AVX2 (see lit_get_simd_level). len must be below
+// 2^32 as offsets are stored in 32 bits.
+void LitBuildStructuralIndex(const char* json, size_t len, std::vector<uint32_t>* index);
+
+#endif
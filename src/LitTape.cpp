@@ -0,0 +1,334 @@
+#include "LitTape.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "LitReader.h"
+
+// getters for walking a LitValue into the tape, lit_to_value creates values through its own LitJson
+static const LitJson view;
+
+// LitReader handler that appends every event to the tape
+class LitTapeBuilder {
+public:
+    explicit LitTapeBuilder(LitTapeDocument* doc) : doc(doc) {}
+
+    bool Null() { return LitPut('n'); }
+    bool Bool(bool b) { return LitPut(b ? 't' : 'f'); }
+    bool Double(double d) {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        return LitPut('d', 0, bits);
+    }
+    bool Int64(int64_t i) { return LitPut('l', 0, static_cast<uint64_t>(i)); }
+    bool Uint64(uint64_t u) { return LitPut('u', 0, u); }
+    bool String(const char* str, size_t len) {
+        std::vector<char>& strings = doc->strings;
+        LitPut('\"', strings.size(), len);
+        strings.insert(strings.end(), str, str + len);
+        strings.push_back('\0');
+        return true;
+    }
+    bool Key(const char* str, size_t len) { return String(str, len); }
+    bool StartObject() { return LitStart('{'); }
+    bool EndObject(size_t member_count) { return LitEnd('}', member_count); }
+    bool StartArray() { return LitStart('['); }
+    bool EndArray(size_t element_count) { return LitEnd(']', element_count); }
+
+private:
+    bool LitPut(char tag, uint64_t payload = 0) {
+        doc->tape.push_back(LitTapeDocument::LitWord(tag, payload));
+        return true;
+    }
+    bool LitPut(char tag, uint64_t payload, uint64_t next) {
+        LitPut(tag, payload);
+        doc->tape.push_back(next);
+        return true;
+    }
+    bool LitStart(char tag) {
+        doc->stack.push_back(doc->tape.size());
+        return LitPut(tag);
+    }
+    bool LitEnd(char tag, size_t count) {
+        // the opening word learns where its container ends
+        doc->tape[doc->stack.back()] |= doc->tape.size();
+        doc->stack.pop_back();
+        return LitPut(tag, count);
+    }
+
+    LitTapeDocument* doc;
+};
+
+ParseResultType LitTapeDocument::LitParse(const char* json) {
+    assert(json != nullptr);
+    tape.clear();
+    strings.clear();
+    stack.clear();
+    LitTapeBuilder builder(this);
+    LitReader<LitTapeBuilder> reader;
+    ParseResultType res = reader.LitParse(json, &builder);
+    if (res != LIT_PARSE_OK) {
+        tape.clear();
+        strings.clear();
+    }
+    return res;
+}
+
+void LitTapeDocument::LitCount(const LitValue& v, size_t* words, size_t* bytes) const {
+    switch (view.lit_get_type(v)) {
+        case LIT_NUMBER: *words += 2; break;
+        case LIT_STRING:
+            *words += 2;
+            *bytes += view.lit_get_string(v).size() + 1;
+            break;
+        case LIT_ARRAY:
+            *words += 2;
+            for (size_t i = 0; i < view.lit_get_array_size(v); ++i) {
+                LitCount(view.lit_get_array_element(v, i), words, bytes);
+            }
+            break;
+        case LIT_OBJECT:
+            *words += 2;
+            for (size_t i = 0; i < view.lit_get_object_size(v); ++i) {
+                *words += 2;
+                *bytes += view.lit_get_object_key_length(v, i) + 1;
+                LitCount(view.lit_get_object_value(v, i), words, bytes);
+            }
+            break;
+        default: *words += 1;
+    }
+}
+
+void LitTapeDocument::LitPutString(const LitValue::String& s) {
+    tape.push_back(LitWord('\"', strings.size()));
+    tape.push_back(s.size());
+    strings.insert(strings.end(), s.begin(), s.end());
+    strings.push_back('\0');
+}
+
+void LitTapeDocument::LitPutValue(const LitValue& v) {
+    switch (view.lit_get_type(v)) {
+        case LIT_NULL: tape.push_back(LitWord('n', 0)); break;
+        case LIT_FALSE: tape.push_back(LitWord('f', 0)); break;
+        case LIT_TRUE: tape.push_back(LitWord('t', 0)); break;
+        case LIT_NUMBER:
+            switch (view.lit_get_number_type(v)) {
+                case LIT_NUMBER_DOUBLE: {
+                    double d = view.lit_get_number(v);
+                    uint64_t bits;
+                    memcpy(&bits, &d, sizeof(bits));
+                    tape.push_back(LitWord('d', 0));
+                    tape.push_back(bits);
+                    break;
+                }
+                case LIT_NUMBER_INT64:
+                    tape.push_back(LitWord('l', 0));
+                    tape.push_back(static_cast<uint64_t>(view.lit_get_int64(v)));
+                    break;
+                case LIT_NUMBER_UINT64:
+                    tape.push_back(LitWord('u', 0));
+                    tape.push_back(view.lit_get_uint64(v));
+                    break;
+            }
+            break;
+        case LIT_STRING: LitPutString(view.lit_get_string(v)); break;
+        case LIT_ARRAY: {
+            size_t start = tape.size();
+            size_t size = view.lit_get_array_size(v);
+            tape.push_back(0);
+            for (size_t i = 0; i < size; ++i) LitPutValue(view.lit_get_array_element(v, i));
+            tape[start] = LitWord('[', tape.size());
+            tape.push_back(LitWord(']', size));
+            break;
+        }
+        case LIT_OBJECT: {
+            size_t start = tape.size();
+            size_t size = view.lit_get_object_size(v);
+            tape.push_back(0);
+            for (size_t i = 0; i < size; ++i) {
+                LitPutString(view.lit_get_object_key(v, i));
+                LitPutValue(view.lit_get_object_value(v, i));
+            }
+            tape[start] = LitWord('{', tape.size());
+            tape.push_back(LitWord('}', size));
+            break;
+        }
+    }
+}
+
+void LitTapeDocument::LitFromValue(const LitValue& v) {
+    size_t words = 0, bytes = 0;
+    LitCount(v, &words, &bytes);
+    tape.clear();
+    strings.clear();
+    tape.reserve(words);
+    strings.reserve(bytes);
+    LitPutValue(v);
+    assert(tape.size() == words && strings.size() == bytes);
+}
+
+void LitTapeDocument::lit_to_value(const LitTapeValue& v, LitValue* res) const {
+    assert(v.lit_is_valid() && res != nullptr);
+    // built for each call, so values come from the default resource of the moment
+    LitJson lit;
+    switch (lit_get_type(v)) {
+        case LIT_NULL: lit.lit_set_null(res); break;
+        case LIT_FALSE: lit.lit_set_boolean(res, false); break;
+        case LIT_TRUE: lit.lit_set_boolean(res, true); break;
+        case LIT_NUMBER:
+            switch (lit_get_number_type(v)) {
+                case LIT_NUMBER_DOUBLE: lit.lit_set_number(res, lit_get_number(v)); break;
+                case LIT_NUMBER_INT64: lit.lit_set_int64(res, lit_get_int64(v)); break;
+                case LIT_NUMBER_UINT64: lit.lit_set_uint64(res, lit_get_uint64(v)); break;
+            }
+            break;
+        case LIT_STRING: lit.lit_set_string(res, lit_get_string(v), lit_get_string_length(v)); break;
+        case LIT_ARRAY: {
+            LitValue::Array arr(lit_get_array_size(v), LitValue(), lit.lit_get_resource());
+            size_t i = 0;
+            for (LitTapeValue e = lit_get_first_element(v); e.lit_is_valid(); e = lit_get_next_element(e)) {
+                lit_to_value(e, &arr[i++]);
+            }
+            lit.lit_set_array(res, std::move(arr));
+            break;
+        }
+        case LIT_OBJECT: {
+            LitValue::Obj obj(lit.lit_get_resource());
+            obj.reserve(lit_get_object_size(v));
+            for (LitTapeValue k = lit_get_first_member(v); k.lit_is_valid(); k = lit_get_next_member(k)) {
+                obj.emplace_back(LitValue::String(lit_get_string(k), lit_get_string_length(k), lit.lit_get_resource()),
+                                 LitValue());
+                lit_to_value(lit_get_member_value(k), &obj.back().second);
+            }
+            lit.lit_set_object(res, std::move(obj));
+            break;
+        }
+    }
+}
+
+size_t LitTapeDocument::LitSkip(size_t pos) const {
+    switch (LitTag(pos)) {
+        case '[':
+        case '{': return LitPayload(pos) + 1;
+        case 'l':
+        case 'u':
+        case 'd':
+        case '\"': return pos + 2;
+        default: return pos + 1;
+    }
+}
+
+LitType LitTapeDocument::lit_get_type(const LitTapeValue& v) const {
+    assert(v.lit_is_valid());
+    switch (LitTag(v.pos)) {
+        case 'n': return LIT_NULL;
+        case 't': return LIT_TRUE;
+        case 'f': return LIT_FALSE;
+        case '\"': return LIT_STRING;
+        case '[': return LIT_ARRAY;
+        case '{': return LIT_OBJECT;
+        default: return LIT_NUMBER;
+    }
+}
+
+bool LitTapeDocument::lit_get_boolean(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_TRUE || lit_get_type(v) == LIT_FALSE);
+    return LitTag(v.pos) == 't';
+}
+
+double LitTapeDocument::lit_get_number(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_NUMBER);
+    uint64_t bits = tape[v.pos + 1];
+    switch (LitTag(v.pos)) {
+        case 'l': return static_cast<double>(static_cast<int64_t>(bits));
+        case 'u': return static_cast<double>(bits);
+        default: {
+            double d;
+            memcpy(&d, &bits, sizeof(d));
+            return d;
+        }
+    }
+}
+
+LitNumberType LitTapeDocument::lit_get_number_type(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_NUMBER);
+    switch (LitTag(v.pos)) {
+        case 'l': return LIT_NUMBER_INT64;
+        case 'u': return LIT_NUMBER_UINT64;
+        default: return LIT_NUMBER_DOUBLE;
+    }
+}
+
+int64_t LitTapeDocument::lit_get_int64(const LitTapeValue& v) const {
+    assert(lit_get_number_type(v) == LIT_NUMBER_INT64);
+    return static_cast<int64_t>(tape[v.pos + 1]);
+}
+
+uint64_t LitTapeDocument::lit_get_uint64(const LitTapeValue& v) const {
+    assert(lit_get_number_type(v) == LIT_NUMBER_UINT64 ||
+           (lit_get_number_type(v) == LIT_NUMBER_INT64 && lit_get_int64(v) >= 0));
+    return tape[v.pos + 1];
+}
+
+const char* LitTapeDocument::lit_get_string(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_STRING);
+    return strings.data() + LitPayload(v.pos);
+}
+
+size_t LitTapeDocument::lit_get_string_length(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_STRING);
+    return tape[v.pos + 1];
+}
+
+size_t LitTapeDocument::lit_get_array_size(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_ARRAY);
+    return LitPayload(LitPayload(v.pos));
+}
+
+LitTapeValue LitTapeDocument::lit_get_array_element(const LitTapeValue& v, size_t index) const {
+    LitTapeValue e = lit_get_first_element(v);
+    for (; e.lit_is_valid() && index > 0; --index) e = lit_get_next_element(e);
+    return e;
+}
+
+LitTapeValue LitTapeDocument::lit_get_first_element(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_ARRAY);
+    return LitTag(v.pos + 1) == ']' ? LitTapeValue() : LitTapeValue(v.pos + 1);
+}
+
+LitTapeValue LitTapeDocument::lit_get_next_element(const LitTapeValue& element) const {
+    assert(element.lit_is_valid());
+    size_t pos = LitSkip(element.pos);
+    return LitTag(pos) == ']' ? LitTapeValue() : LitTapeValue(pos);
+}
+
+size_t LitTapeDocument::lit_get_object_size(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_OBJECT);
+    return LitPayload(LitPayload(v.pos));
+}
+
+LitTapeValue LitTapeDocument::lit_find_object_value(const LitTapeValue& v, const char* key, size_t klen) const {
+    assert(key != nullptr);
+    for (LitTapeValue k = lit_get_first_member(v); k.lit_is_valid(); k = lit_get_next_member(k)) {
+        if (lit_get_string_length(k) == klen && memcmp(lit_get_string(k), key, klen) == 0) {
+            return lit_get_member_value(k);
+        }
+    }
+    return LitTapeValue();
+}
+
+LitTapeValue LitTapeDocument::lit_get_first_member(const LitTapeValue& v) const {
+    assert(lit_get_type(v) == LIT_OBJECT);
+    return LitTag(v.pos + 1) == '}' ? LitTapeValue() : LitTapeValue(v.pos + 1);
+}
+
+LitTapeValue LitTapeDocument::lit_get_next_member(const LitTapeValue& key) const {
+    assert(lit_get_type(key) == LIT_STRING);
+    size_t pos = LitSkip(key.pos + 2);
+    return LitTag(pos) == '}' ? LitTapeValue() : LitTapeValue(pos);
+}
+
+LitTapeValue LitTapeDocument::lit_get_member_value(const LitTapeValue& key) const {
+    assert(lit_get_type(key) == LIT_STRING);
+    return LitTapeValue(key.pos + 2);
+}
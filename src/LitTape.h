@@ -0,0 +1,113 @@
+#ifndef LITTAPE_H_
+#define LITTAPE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "LitJson.h"
+#include "LitValue.h"
+
+// A value inside a LitTapeDocument, only its position on the tape. Handles are trivially copyable and stay valid
+// until the document is filled again.
+class LitTapeValue {
+    friend class LitTapeDocument;
+
+public:
+    LitTapeValue() = default;
+
+    // false for the handle after the last element or member and for lookups that found nothing
+    bool lit_is_valid() const { return pos != kNone; }
+
+private:
+    static const size_t kNone = static_cast<size_t>(-1);
+
+    explicit LitTapeValue(size_t pos) : pos(pos) {}
+
+    size_t pos = kNone;
+};
+
+// Read-only document in two flat buffers: a tape of 64-bit words holding the structure and the scalars in
+// document order, and one buffer with the bytes of every string and key. A word keeps a tag in its top byte and a
+// payload below it:
+//
+//     n t f              null, true, false
+//     l u d  + 1 word    int64, uint64, double, the number in the next word
+//     "      + 1 word    string or key: offset into the string buffer, the length in the next word
+//     [ {                the position of the matching ] or }, so skipping a subtree is a single jump
+//     ] }                the number of elements / members
+//
+// Walking a document reads both buffers front to back and dropping it frees two blocks, however many values it
+// holds. LitFromValue sizes the buffers exactly before filling them, a parse grows them like a std::vector and a
+// document that is filled again reuses them. Indexing an array or object is O(index), iterate to visit them all.
+class LitTapeDocument {
+public:
+    LitTapeDocument() = default;
+    LitTapeDocument(const LitTapeDocument&) = delete;
+    LitTapeDocument& operator=(const LitTapeDocument&) = delete;
+
+    // Json Parse with LitReader, same errors as LitJson::LitParse. On error the root is invalid.
+    ParseResultType LitParse(const char* json);
+    // copy a LitValue tree, exactly two allocations unless the buffers are already large enough
+    void LitFromValue(const LitValue& v);
+    // deep copy a subtree into a LitValue
+    void lit_to_value(const LitTapeValue& v, LitValue* res) const;
+
+    // getter function, const so a document can be read from several threads
+    LitTapeValue lit_get_root() const { return tape.empty() ? LitTapeValue() : LitTapeValue(0); }
+    LitType lit_get_type(const LitTapeValue& v) const;
+
+    bool lit_get_boolean(const LitTapeValue& v) const;
+    // integers are converted, above 2^53 that may round
+    double lit_get_number(const LitTapeValue& v) const;
+    LitNumberType lit_get_number_type(const LitTapeValue& v) const;
+    int64_t lit_get_int64(const LitTapeValue& v) const;
+    // also valid for non-negative int64 numbers
+    uint64_t lit_get_uint64(const LitTapeValue& v) const;
+
+    // strings are NUL-terminated but may contain '\0', use the length. Also reads object keys.
+    const char* lit_get_string(const LitTapeValue& v) const;
+    size_t lit_get_string_length(const LitTapeValue& v) const;
+
+    // O(1), the count is kept on the closing word
+    size_t lit_get_array_size(const LitTapeValue& v) const;
+    LitTapeValue lit_get_array_element(const LitTapeValue& v, size_t index) const;
+    // iteration: invalid for an empty array / after the last element
+    LitTapeValue lit_get_first_element(const LitTapeValue& v) const;
+    LitTapeValue lit_get_next_element(const LitTapeValue& element) const;
+
+    size_t lit_get_object_size(const LitTapeValue& v) const;
+    // first member named key, an invalid handle if there is none
+    LitTapeValue lit_find_object_value(const LitTapeValue& v, const char* key, size_t klen) const;
+    // iteration over the keys: invalid for an empty object / after the last member
+    LitTapeValue lit_get_first_member(const LitTapeValue& v) const;
+    LitTapeValue lit_get_next_member(const LitTapeValue& key) const;
+    LitTapeValue lit_get_member_value(const LitTapeValue& key) const;
+
+    size_t lit_get_tape_size() const { return tape.size(); }
+    size_t lit_get_string_buffer_size() const { return strings.size(); }
+
+private:
+    friend class LitTapeBuilder;
+
+    static const int kTagShift = 56;
+    static const uint64_t kPayloadMask = (uint64_t(1) << kTagShift) - 1;
+
+    static uint64_t LitWord(char tag, uint64_t payload) { return uint64_t(tag) << kTagShift | payload; }
+    char LitTag(size_t pos) const { return static_cast<char>(tape[pos] >> kTagShift); }
+    uint64_t LitPayload(size_t pos) const { return tape[pos] & kPayloadMask; }
+    // the position right after the value at pos
+    size_t LitSkip(size_t pos) const;
+
+    // LitFromValue
+    void LitCount(const LitValue& v, size_t* words, size_t* bytes) const;
+    void LitPutString(const LitValue::String& s);
+    void LitPutValue(const LitValue& v);
+
+    std::vector<uint64_t> tape;
+    std::vector<char> strings;
+    std::vector<size_t> stack;  // open containers while parsing, reused across parses
+};
+
+#endif
@@ -1,20 +1,36 @@
 #include "LitValue.h"
 
+#include "LitObjectIndex.h"
+
 LitValue& LitValue::operator=(const LitValue& v) {
     if (type == LIT_STRING && v.type != LIT_STRING) str.~basic_string();
-    if (type == LIT_ARRAY && v.type != LIT_ARRAY) arr.~vector<LitValue>();
-    if (type == LIT_OBJECT && v.type != LIT_OBJECT) obj.~vector<std::pair<std::string, LitValue>>();
+    if (type == LIT_ARRAY && v.type != LIT_ARRAY) arr.~Array();
+    if (type == LIT_OBJECT && v.type != LIT_OBJECT) obj.~ObjData();
 
     if (type == LIT_STRING && v.type == LIT_STRING) {
         str = v.str;
     } else if (type == LIT_ARRAY && v.type == LIT_ARRAY) {
         arr = v.arr;
     } else if (type == LIT_OBJECT && v.type == LIT_OBJECT) {
-        obj = v.obj;
+        obj.members = v.obj.members;
+        obj.DropIndex();
     } else {
         CopyUnion(v);
     }
     type = v.type;
+    num_type = v.num_type;
+    return *this;
+}
+
+LitValue& LitValue::operator=(LitValue&& v) noexcept {
+    if (this == &v) return *this;
+
+    // v may live inside this value (e.g. an element of arr), take it out before freeing
+    LitValue t(std::move(v));
+    UnionFree();
+    type = t.type;
+    num_type = t.num_type;
+    MoveUnion(&t);
     return *this;
 }
 
@@ -30,26 +46,63 @@ LitValue& LitValue::operator=(double d) {
 
     n = d;
     type = LIT_NUMBER;
+    num_type = LIT_NUMBER_DOUBLE;
     return *this;
 }
 
+LitValue& LitValue::operator=(int64_t v) {
+    UnionFree();
+
+    i = v;
+    type = LIT_NUMBER;
+    num_type = LIT_NUMBER_INT64;
+    return *this;
+}
+
+LitValue& LitValue::operator=(uint64_t v) {
+    UnionFree();
+
+    // keep one representation per value, uint64 only holds what int64 cannot
+    if (v <= static_cast<uint64_t>(INT64_MAX)) {
+        i = static_cast<int64_t>(v);
+        num_type = LIT_NUMBER_INT64;
+    } else {
+        u = v;
+        num_type = LIT_NUMBER_UINT64;
+    }
+    type = LIT_NUMBER;
+    return *this;
+}
+
+// a std::string is always copied, a string of this value keeps its resource
 LitValue& LitValue::operator=(const std::string& s) {
     if (type == LIT_STRING) {
-        str = s;
+        str.assign(s.data(), s.size());
     } else {
         UnionFree();
-        new (&str) std::string(s);
+        new (&str) String(s.data(), s.size());
     }
     type = LIT_STRING;
     return *this;
 }
 
-LitValue& LitValue::operator=(const std::vector<LitValue>& a) {
+LitValue& LitValue::operator=(const Array& a) {
     if (type == LIT_ARRAY) {
         arr = a;
     } else {
         UnionFree();
-        new (&arr) std::vector<LitValue>(a);
+        new (&arr) Array(a);
+    }
+    type = LIT_ARRAY;
+    return *this;
+}
+
+LitValue& LitValue::operator=(Array&& a) {
+    if (type == LIT_ARRAY) {
+        arr = std::move(a);
+    } else {
+        UnionFree();
+        new (&arr) Array(std::move(a));
     }
     type = LIT_ARRAY;
     return *this;
@@ -57,10 +110,23 @@ LitValue& LitValue::operator=(const std::vector<LitValue>& a) {
 
 LitValue& LitValue::operator=(const Obj& o) {
     if (type == LIT_OBJECT) {
-        obj = o;
+        obj.members = o;
+        obj.DropIndex();
+    } else {
+        UnionFree();
+        new (&obj) ObjData(o);
+    }
+    type = LIT_OBJECT;
+    return *this;
+}
+
+LitValue& LitValue::operator=(Obj&& o) {
+    if (type == LIT_OBJECT) {
+        obj.members = std::move(o);
+        obj.DropIndex();
     } else {
         UnionFree();
-        new (&obj) Obj(o);
+        new (&obj) ObjData(std::move(o));
     }
     type = LIT_OBJECT;
     return *this;
@@ -68,15 +134,46 @@ LitValue& LitValue::operator=(const Obj& o) {
 
 void LitValue::CopyUnion(const LitValue& v) {
     switch (v.type) {
-        case LIT_NUMBER: n = v.n; break;
-        case LIT_STRING: new (&str) std::string(v.str); break;
-        case LIT_ARRAY: new (&arr) std::vector<LitValue>(v.arr); break;
-        case LIT_OBJECT: new (&obj) Obj(v.obj); break;
+        case LIT_NUMBER:
+            // int64 and uint64 share their bits
+            if (v.num_type == LIT_NUMBER_DOUBLE) {
+                n = v.n;
+            } else {
+                u = v.u;
+            }
+            break;
+        case LIT_STRING: new (&str) String(v.str); break;
+        case LIT_ARRAY: new (&arr) Array(v.arr); break;
+        case LIT_OBJECT: new (&obj) ObjData(v.obj.members); break;
+        default: break;
     }
 }
 
+void LitValue::MoveUnion(LitValue* v) noexcept {
+    switch (v->type) {
+        case LIT_NUMBER:
+            // int64 and uint64 share their bits
+            if (v->num_type == LIT_NUMBER_DOUBLE) {
+                n = v->n;
+            } else {
+                u = v->u;
+            }
+            break;
+        case LIT_STRING: new (&str) String(std::move(v->str)); break;
+        case LIT_ARRAY: new (&arr) Array(std::move(v->arr)); break;
+        case LIT_OBJECT: new (&obj) ObjData(std::move(v->obj)); break;
+        default: break;
+    }
+    v->UnionFree();
+    v->type = LIT_NULL;
+}
+
 void LitValue::UnionFree() {
     if (type == LIT_STRING) str.~basic_string();
-    if (type == LIT_ARRAY) arr.~vector<LitValue>();
-    if (type == LIT_OBJECT) obj.~vector<std::pair<std::string, LitValue>>();
+    if (type == LIT_ARRAY) arr.~Array();
+    if (type == LIT_OBJECT) obj.~ObjData();
+}
+
+void LitValue::ObjData::DropIndex() {
+    delete index.exchange(nullptr);
 }
\ No newline at end of file
@@ -1,43 +1,81 @@
 #ifndef LITVALUE_H_
 #define LITVALUE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "LitMemory.h"
+
 class LitJson;
+class LitObjectIndex;
 
 enum LitType { LIT_NULL, LIT_FALSE, LIT_TRUE, LIT_NUMBER, LIT_STRING, LIT_ARRAY, LIT_OBJECT };
 
+// how a LIT_NUMBER is stored. Integers without fraction or exponent are kept exact: as int64 when they fit, as
+// uint64 only above INT64_MAX, everything else (including -0) is a double
+enum LitNumberType { LIT_NUMBER_DOUBLE, LIT_NUMBER_INT64, LIT_NUMBER_UINT64 };
+
+// returned by key lookups that find nothing
+const size_t LIT_KEY_NOT_EXIST = static_cast<size_t>(-1);
+
 class LitValue {
     friend class LitJson;
-    typedef std::vector<std::pair<std::string, LitValue>> Obj;
 
 public:
-    LitValue() : n(0.0), type(LIT_NUMBER) {}
-    LitValue(const LitValue& v) : type(v.type) { CopyUnion(v); }
-    ~LitValue() {
-        if (type == LIT_STRING) str.~basic_string();
-        if (type == LIT_ARRAY) arr.~vector();
-    }
+    // allocator-aware like std::pmr containers, see LitMemory.h. Built without a resource they use the default one.
+    typedef LitString String;
+    typedef std::vector<LitValue, LitAllocator<LitValue>> Array;
+    typedef std::vector<std::pair<String, LitValue>, LitAllocator<std::pair<String, LitValue>>> Obj;
+
+    LitValue() : n(0.0), type(LIT_NUMBER), num_type(LIT_NUMBER_DOUBLE) {}
+    LitValue(const LitValue& v) : type(v.type), num_type(v.num_type) { CopyUnion(v); }
+    // the moved-from value is left as null
+    LitValue(LitValue&& v) noexcept : type(v.type), num_type(v.num_type) { MoveUnion(&v); }
+    ~LitValue() { UnionFree(); }
 
     LitValue& operator=(const LitValue& v);
+    LitValue& operator=(LitValue&& v) noexcept;
     LitValue& operator=(bool);
     LitValue& operator=(double);
+    LitValue& operator=(int64_t);
+    LitValue& operator=(uint64_t);
     LitValue& operator=(const std::string&);
-    LitValue& operator=(const std::vector<LitValue>&);
+    LitValue& operator=(const Array&);
+    LitValue& operator=(Array&&);
     LitValue& operator=(const Obj&);
+    LitValue& operator=(Obj&&);
 
 private:
+    // the members plus a hash index over their keys. The index is built by the first lookup into a large object
+    // and dropped whenever the members are replaced, it lives in the bytes String leaves free in the union.
+    // Lookups are const and may run concurrently, so the index is published with a compare-and-swap.
+    struct ObjData {
+        explicit ObjData(const Obj& o) : members(o), index(nullptr) {}
+        explicit ObjData(Obj&& o) noexcept : members(std::move(o)), index(nullptr) {}
+        ObjData(ObjData&& o) noexcept : members(std::move(o.members)), index(o.index.exchange(nullptr)) {}
+        ~ObjData() { DropIndex(); }
+        void DropIndex();
+
+        Obj members;
+        mutable std::atomic<LitObjectIndex*> index;
+    };
+
     void CopyUnion(const LitValue&);
+    void MoveUnion(LitValue*) noexcept;
     void UnionFree();
 
     union {
         double n;
-        std::string str;
-        std::vector<LitValue> arr;
-        Obj obj;
+        int64_t i;
+        uint64_t u;
+        String str;
+        Array arr;
+        ObjData obj;
     };
     LitType type;
+    LitNumberType num_type;  // only meaningful for LIT_NUMBER, fits in the padding after type
 };
 
-#endif
\ No newline at end of file
+#endif